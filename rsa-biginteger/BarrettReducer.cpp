@@ -0,0 +1,47 @@
+#include <stdexcept>
+#include "BarrettReducer.h"
+
+
+//-------------------------------------- Constructor -----------------------------------------------------------
+BarrettReducer::BarrettReducer(const BigInteger& mod) {
+    if (mod <= 0)
+        throw domain_error("BarrettReducer: modulus must be positive");
+
+    modulus = mod;
+    k = mod.getLimbs().size();
+
+    LimbVector power(2 * k + 1, 0);
+    power[2 * k] = 1;
+    mu.setLimbs(power);
+    mu /= modulus;
+}
+
+
+BigInteger BarrettReducer::getModulus() const {
+    return modulus;
+}
+
+
+//-------------------------------------- Reduction ------------------------------------------------------------
+// HAC 14.42: q = floor(floor(x / b^(k-1)) * mu / b^(k+1)) undershoots x / m by at most 2
+BigInteger BarrettReducer::reduce(const BigInteger& value) const {
+    bool negative = value.getSign();
+    BigInteger x = value.absolute();
+
+    if (x.getLimbs().size() > 2 * k)
+        return (negative ? -x : x) % modulus;
+    if (x < modulus)
+        return negative ? -x : x;
+
+    BigInteger q = ((x >> 64 * (k - 1)) * mu) >> 64 * (k + 1);
+    BigInteger r = x - q * modulus;
+    while (r >= modulus)
+        r -= modulus;
+
+    return negative ? -r : r;
+}
+
+
+BigInteger operator % (const BigInteger& x, const BarrettReducer& reducer) {
+    return reducer.reduce(x);
+}
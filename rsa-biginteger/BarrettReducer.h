@@ -0,0 +1,28 @@
+#ifndef BARRETTREDUCER_H
+#define BARRETTREDUCER_H
+
+#include <vector>
+#include "BigInteger.h"
+
+//-------------------------------------------------------------
+// Barrett reduction modulo a fixed m of k limbs. mu = floor(2^(128k) / m) is
+// computed once, after which any x < m^2 is reduced with two multiplications,
+// limb shifts and at most two subtractions. Unlike Montgomery form there is no
+// conversion in or out, and m does not have to be odd.
+class BarrettReducer {
+private:
+    BigInteger modulus;
+    BigInteger mu;
+    size_t k; // limbs of the modulus
+
+public:
+    BarrettReducer(const BigInteger& mod); // mod must be positive
+
+    BigInteger getModulus() const;
+    BigInteger reduce(const BigInteger& x) const; // same result as x % modulus
+};
+
+// x % reducer.getModulus(), through the reducer's precomputed reciprocal
+BigInteger operator % (const BigInteger& x, const BarrettReducer& reducer);
+
+#endif
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include "BatchExponentiation.h"
+#include "LimbKernels.h"
+#include "LimbPool.h"
+#include "MontgomeryContext.h"
+#include "VectorMontgomery.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define VECTOR_KERNELS
+#include <immintrin.h>
+#endif
+
+// Caps the accumulators that live on the stack; every lane sum stays far below 2^64.
+static const size_t MAX_BATCH_LIMBS = 128;
+static const size_t IFMA_DIGITS = (MAX_BATCH_LIMBS * 64 + 2 + 51) / 52;
+static const size_t AVX2_DIGITS = (MAX_BATCH_LIMBS * 64 + 2 + 25) / 26;
+static const size_t MAX_TABLE_BITS = 5;
+
+
+//-------------------------------------- Kernels -------------------------------------------------------------
+#ifdef VECTOR_KERNELS
+// Operands hold digit j of lane l at j * 8 + l, so one vector is one digit of all eight
+// lanes. Row i adds a*b[i] and y*N at digit i, with y picked per lane to clear digit
+// i; rather than moving lanes down after each row, row i writes from digit i up and
+// the result is read from digit m. High halves of products land one digit further up.
+__attribute__((target("avx512f,avx512ifma")))
+static void batchMultiplyIFMA(limb_t* r, const limb_t* a, const limb_t* b, const limb_t* n,
+                              const limb_t* k0, size_t digits) {
+    __m512i acc[2 * IFMA_DIGITS];
+    const __m512i zero = _mm512_setzero_si512(), mask = _mm512_set1_epi64(((limb_t) 1 << 52) - 1);
+    const __m512i k = _mm512_loadu_si512(k0);
+    for (size_t j = 0; j < 2 * digits; j++)
+        acc[j] = zero;
+
+    for (size_t i = 0; i < digits; i++) {
+        __m512i bi = _mm512_loadu_si512(b + 8 * i);
+        __m512i low = _mm512_madd52lo_epu64(acc[i], _mm512_loadu_si512(a), bi);
+        __m512i y = _mm512_madd52lo_epu64(zero, low, k);
+        for (size_t j = 0; j < digits; j++) {
+            __m512i aj = _mm512_loadu_si512(a + 8 * j), nj = _mm512_loadu_si512(n + 8 * j);
+            acc[i + j] = _mm512_madd52lo_epu64(_mm512_madd52lo_epu64(acc[i + j], aj, bi), nj, y);
+        }
+        for (size_t j = 0; j < digits; j++) {
+            __m512i aj = _mm512_loadu_si512(a + 8 * j), nj = _mm512_loadu_si512(n + 8 * j);
+            acc[i + j + 1] = _mm512_madd52hi_epu64(_mm512_madd52hi_epu64(acc[i + j + 1], aj, bi), nj, y);
+        }
+        acc[i + 1] = _mm512_add_epi64(acc[i + 1], _mm512_srli_epi64(acc[i], 52));
+    }
+
+    __m512i carry = zero;
+    for (size_t j = 0; j < digits; j++) {
+        __m512i x = _mm512_add_epi64(acc[digits + j], carry);
+        _mm512_storeu_si512(r + 8 * j, _mm512_and_si512(x, mask));
+        carry = _mm512_srli_epi64(x, 52);
+    }
+}
+
+
+// the same rows on four lanes of 26-bit digits, whose products fit a lane whole
+__attribute__((target("avx2")))
+static void batchMultiplyAVX2(limb_t* r, const limb_t* a, const limb_t* b, const limb_t* n,
+                              const limb_t* k0, size_t digits) {
+    __m256i acc[2 * AVX2_DIGITS];
+    const __m256i zero = _mm256_setzero_si256(), mask = _mm256_set1_epi64x(((limb_t) 1 << 26) - 1);
+    const __m256i k = _mm256_loadu_si256((const __m256i*) k0);
+    for (size_t j = 0; j < 2 * digits; j++)
+        acc[j] = zero;
+
+    for (size_t i = 0; i < digits; i++) {
+        __m256i bi = _mm256_loadu_si256((const __m256i*) (b + 4 * i));
+        __m256i low = _mm256_add_epi64(acc[i], _mm256_mul_epu32(_mm256_loadu_si256((const __m256i*) a), bi));
+        __m256i y = _mm256_and_si256(_mm256_mul_epu32(low, k), mask);
+        for (size_t j = 0; j < digits; j++) {
+            __m256i aj = _mm256_loadu_si256((const __m256i*) (a + 4 * j));
+            __m256i nj = _mm256_loadu_si256((const __m256i*) (n + 4 * j));
+            acc[i + j] = _mm256_add_epi64(acc[i + j], _mm256_add_epi64(_mm256_mul_epu32(aj, bi),
+                                                                          _mm256_mul_epu32(nj, y)));
+        }
+        acc[i + 1] = _mm256_add_epi64(acc[i + 1], _mm256_srli_epi64(acc[i], 26));
+    }
+
+    __m256i carry = zero;
+    for (size_t j = 0; j < digits; j++) {
+        __m256i x = _mm256_add_epi64(acc[digits + j], carry);
+        _mm256_storeu_si256((__m256i*) (r + 4 * j), _mm256_and_si256(x, mask));
+        carry = _mm256_srli_epi64(x, 26);
+    }
+}
+#endif
+
+
+//-------------------------------------- Lane layout ---------------------------------------------------------
+// One lockstep group: the moduli interleaved digit by digit, R' = 2^(digitBits * digits)
+// above four times the longest of them, and each lane's Montgomery factor.
+struct LaneGroup {
+    VectorMontgomery::Kernel kernel;
+    size_t lanes;
+    unsigned digitBits;
+    size_t digits;
+    LimbVector n;
+    LimbVector k0; // -N^-1 mod 2^digitBits per lane
+
+    size_t size() const { return digits * lanes; }
+
+    // r = a*b*R'^-1 lane by lane, below 2N for a and b below 2N; r may be a or b
+    void multiply(limb_t* r, const limb_t* a, const limb_t* b) const {
+#ifdef VECTOR_KERNELS
+        if (kernel == VectorMontgomery::IFMA)
+            batchMultiplyIFMA(r, a, b, n.data(), k0.data(), digits);
+        else
+            batchMultiplyAVX2(r, a, b, n.data(), k0.data(), digits);
+#else
+        (void) r; (void) a; (void) b;
+#endif
+    }
+
+    void putLane(LimbVector& d, const LimbVector& a, size_t lane) const {
+        limb_t mask = ((limb_t) 1 << digitBits) - 1;
+        for (size_t j = 0; j < digits; j++) {
+            size_t bit = j * digitBits, limb = bit / 64, shift = bit % 64;
+            limb_t x = 0;
+            if (limb < a.size()) {
+                x = a[limb] >> shift;
+                if (shift + digitBits > 64 && limb + 1 < a.size())
+                    x |= a[limb + 1] << (64 - shift);
+            }
+            d[j * lanes + lane] = x & mask;
+        }
+    }
+
+    LimbVector takeLane(const LimbVector& d, size_t lane) const {
+        LimbVector limbs((digits * digitBits + 63) / 64, 0);
+        for (size_t j = 0; j < digits; j++) {
+            size_t bit = j * digitBits, limb = bit / 64, shift = bit % 64;
+            limbs[limb] |= d[j * lanes + lane] << shift;
+            if (shift + digitBits > 64)
+                limbs[limb + 1] |= d[j * lanes + lane] >> (64 - shift);
+        }
+        return limbs;
+    }
+};
+
+
+// The per-modulus constants of a lane: R'^2 mod N, which takes a value into Montgomery
+// form with one lane product, and -N^-1 mod 2^digitBits. Kept per modulus and digit
+// count for the whole batch, so lanes sharing a modulus share them.
+struct LaneConstants {
+    BigInteger factor;
+    limb_t k0;
+};
+
+typedef map<pair<BigInteger, size_t>, LaneConstants> ConversionCache;
+
+static const LaneConstants& laneConstants(ConversionCache& cache, const BigInteger& mod, size_t radixBits,
+                                          unsigned digitBits) {
+    pair<BigInteger, size_t> key(mod, radixBits);
+    ConversionCache::iterator it = cache.find(key);
+    if (it == cache.end()) {
+        LaneConstants constants;
+        constants.factor = (BigInteger(1) << (2 * radixBits)) % mod;
+        constants.k0 = (0 - mpn_binvert_limb(mod.getLimbs()[0])) & (((limb_t) 1 << digitBits) - 1);
+        it = cache.insert(make_pair(key, constants)).first;
+    }
+    return it->second;
+}
+
+
+// k-bit window of e starting at bit, read from the top down
+static size_t windowAt(const BigInteger& e, size_t bit, size_t k) {
+    size_t value = 0;
+    for (size_t l = bit + k; l-- > bit; )
+        value = (value << 1) | (e > 0 && e.testBit(l));
+    return value;
+}
+
+
+// Fixed-window ladder over the longest exponent: every window is k squarings in all
+// lanes and one product with the table entry each lane's own window selects, so the
+// lanes never diverge. Shorter exponents just start with windows of zeros.
+static void powerGroup(const BigInteger* bases, const BigInteger* exponents, const BigInteger* moduli,
+                       size_t count, VectorMontgomery::Kernel kernel, ConversionCache& cache, BigInteger* results) {
+    LaneGroup group;
+    group.kernel = kernel;
+    group.lanes = kernel == VectorMontgomery::IFMA ? 8 : 4;
+    group.digitBits = kernel == VectorMontgomery::IFMA ? 52 : 26;
+
+    size_t modBits = 0, expBits = 0;
+    for (size_t l = 0; l < count; l++) {
+        modBits = max(modBits, moduli[l].bitLength());
+        if (exponents[l] > 0)
+            expBits = max(expBits, exponents[l].bitLength());
+    }
+    group.digits = (modBits + 2 + group.digitBits - 1) / group.digitBits;
+    size_t radixBits = group.digits * group.digitBits;
+
+    // lanes past count repeat lane 0 with exponent 0 and are dropped at the end
+    size_t size = group.size();
+    group.n.assign(size, 0);
+    group.k0.assign(group.lanes, 0);
+    LimbVector base(size, 0), factor(size, 0), one(size, 0);
+    for (size_t l = 0; l < group.lanes; l++) {
+        size_t src = l < count ? l : 0;
+        const BigInteger& mod = moduli[src];
+        BigInteger reduced = bases[src] % mod;
+        if (reduced.getSign())
+            reduced += mod;
+
+        const LaneConstants& constants = laneConstants(cache, mod, radixBits, group.digitBits);
+        group.k0[l] = constants.k0;
+        group.putLane(group.n, mod.getLimbs(), l);
+        group.putLane(base, l < count ? reduced.getLimbs() : LimbVector(), l);
+        group.putLane(factor, constants.factor.getLimbs(), l);
+        one[l] = 1;
+    }
+
+    size_t k = min((size_t) MontgomeryContext::windowSize(expBits), MAX_TABLE_BITS);
+    vector<LimbVector> table(1 << k, LimbVector(size));
+    group.multiply(table[0].data(), one.data(), factor.data());
+    if (table.size() > 1) {
+        group.multiply(table[1].data(), base.data(), factor.data());
+        for (size_t w = 2; w < table.size(); w++)
+            group.multiply(table[w].data(), table[w - 1].data(), table[1].data());
+    }
+
+    size_t windows = (expBits + k - 1) / k;
+    LimbVector x(size), selected(size);
+    for (size_t w = windows; w-- > 0; ) {
+        LimbVector& target = w + 1 == windows ? x : selected;
+        for (size_t l = 0; l < group.lanes; l++) {
+            const LimbVector& entry = table[l < count ? windowAt(exponents[l], w * k, k) : 0];
+            for (size_t j = 0; j < group.digits; j++)
+                target[j * group.lanes + l] = entry[j * group.lanes + l];
+        }
+        if (w + 1 == windows)
+            continue;
+        for (size_t s = 0; s < k; s++)
+            group.multiply(x.data(), x.data(), x.data());
+        group.multiply(x.data(), x.data(), selected.data());
+    }
+    if (windows == 0)
+        x = table[0];
+
+    group.multiply(x.data(), x.data(), one.data());
+    for (size_t l = 0; l < count; l++) {
+        results[l].setLimbs(group.takeLane(x, l));
+        if (results[l] >= moduli[l])
+            results[l] -= moduli[l];
+    }
+}
+
+
+//-------------------------------------- Entry points --------------------------------------------------------
+size_t batchLanes() {
+    switch (VectorMontgomery::activeKernel()) {
+    case VectorMontgomery::IFMA:
+        return 8;
+    case VectorMontgomery::AVX2:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+
+vector<BigInteger> powerBatch(const vector<BigInteger>& bases, const vector<BigInteger>& exponents,
+                              const vector<BigInteger>& moduli) {
+    if (bases.size() != exponents.size() || bases.size() != moduli.size())
+        throw domain_error("powerBatch: bases, exponents and moduli must have the same length");
+    for (size_t i = 0; i < moduli.size(); i++) {
+        if (moduli[i].getSign() || moduli[i].isEven())
+            throw domain_error("powerBatch: every modulus must be odd and positive");
+    }
+
+    LimbPool::Scope scope;
+    vector<BigInteger> results(bases.size());
+    VectorMontgomery::Kernel kernel = VectorMontgomery::activeKernel();
+    size_t lanes = batchLanes();
+    ConversionCache cache;
+    map<BigInteger, MontgomeryContext> contexts;
+    for (size_t first = 0; first < bases.size(); first += lanes) {
+        size_t count = min(lanes, bases.size() - first);
+        size_t longest = 0;
+        for (size_t l = first; l < first + count; l++)
+            longest = max(longest, moduli[l].getLimbs().size());
+
+        if (lanes > 1 && longest <= MAX_BATCH_LIMBS) {
+            powerGroup(&bases[first], &exponents[first], &moduli[first], count, kernel, cache, &results[first]);
+            continue;
+        }
+        for (size_t l = first; l < first + count; l++) {
+            map<BigInteger, MontgomeryContext>::iterator it = contexts.find(moduli[l]);
+            if (it == contexts.end())
+                it = contexts.insert(make_pair(moduli[l], MontgomeryContext(moduli[l]))).first;
+            const MontgomeryContext& ctx = it->second;
+            results[l] = ctx.fromMont(ctx.power(ctx.toMont(bases[l]), exponents[l]));
+        }
+    }
+    return results;
+}
+
+
+vector<BigInteger> powerBatch(const vector<BigInteger>& bases, const vector<BigInteger>& exponents,
+                              const BigInteger& modulus) {
+    return powerBatch(bases, exponents, vector<BigInteger>(bases.size(), modulus));
+}
@@ -0,0 +1,32 @@
+#ifndef BATCHEXPONENTIATION_H
+#define BATCHEXPONENTIATION_H
+
+#include <vector>
+#include "BigInteger.h"
+
+//-------------------------------------------------------------
+// Multi-buffer modular exponentiation: independent (base, exponent, modulus) tuples
+// run in lockstep, one SIMD lane per tuple, so a group of batchLanes() of them costs
+// about as much as one vector ladder over the longest modulus. Digit i of every lane
+// sits in one vector, so each lane picks its own Montgomery factor and no carry ever
+// crosses lanes. All lanes square together through a fixed window over the longest
+// exponent; only the table entry each window multiplies by differs.
+//
+// Lanes may share a modulus, as the two CRT halves of many decryptions under one key
+// do, and its constants are then worked out once for the whole batch. Moduli of about
+// the same length batch best, since every lane is as long as the longest one.
+// Without a vector kernel, or above 8192-bit moduli, the tuples go one by one through
+// MontgomeryContext.
+
+// results[i] = bases[i]^exponents[i] mod moduli[i] for odd positive moduli; exponents
+// at or below 0 give 1 mod moduli[i]
+vector<BigInteger> powerBatch(const vector<BigInteger>& bases, const vector<BigInteger>& exponents,
+                              const vector<BigInteger>& moduli);
+// every tuple under the one modulus
+vector<BigInteger> powerBatch(const vector<BigInteger>& bases, const vector<BigInteger>& exponents,
+                              const BigInteger& modulus);
+
+// tuples per lockstep group: 8 with AVX-512 IFMA, 4 with AVX2, 1 without either
+size_t batchLanes();
+
+#endif
@@ -1,480 +1,861 @@
-#ifndef BIGINTEGER_H
-#define BIGINTEGER_H
-
-#include <iostream>
-#include <string>
-#include <sstream>
-#include <cmath>
-#include "BigInteger.h"
-#define MAX 10000 // for strings
-
-BigInteger::BigInteger() // empty constructor initializes zero
-{
-	number = "0";
-	sign = false;
-}
-//-------------------------------------------------------------
-BigInteger::BigInteger(string s) // "string" constructor
-{
-	if( isdigit(s[0]) ) // if not signed
-	{
-		setNumber(s);
-		sign = false; // +ve
-	}
-	else
-	{
-		setNumber( s.substr(1) );
-		sign = (s[0] == '-');
-	}
-}
-//-------------------------------------------------------------
-BigInteger::BigInteger(string s, bool sin) // "string" constructor
-{
-	setNumber( s );
-	setSign( sin );
-}
-//-------------------------------------------------------------
-BigInteger::BigInteger(int n) // "int" constructor
-{
-	stringstream ss;
-	string s;
-	ss << n;
-	ss >> s;
-
-
-	if( isdigit(s[0]) ) // if not signed
-	{
-		setNumber( s );
-		setSign( false ); // +ve
-	}
-	else
-	{
-		setNumber( s.substr(1) );
-		setSign( s[0] == '-' );
-	}
-}
-//-------------------------------------------------------------
-void BigInteger::setNumber(string s)
-{
-	number = s;
-}
-//-------------------------------------------------------------
-const string& BigInteger::getNumber() // retrieves the number
-{
-	return number;
-}
-//-------------------------------------------------------------
-void BigInteger::setSign(bool s)
-{
-	sign = s;
-}
-//-------------------------------------------------------------
-const bool& BigInteger::getSign()
-{
-	return sign;
-}
-//-------------------------------------------------------------
-// returns the absolute value
-BigInteger BigInteger::absolute()
-{
-	return BigInteger( getNumber() ); // +ve by default
-}
-//-------------------------------------------------------------
-void BigInteger::operator = (BigInteger b)
-{
-	setNumber( b.getNumber() );
-	setSign( b.getSign() );
-}
-//-------------------------------------------------------------
-bool BigInteger::operator == (BigInteger b)
-{
-	return equals((*this) , b);
-}
-//-------------------------------------------------------------
-bool BigInteger::operator != (BigInteger b)
-{
-	return ! equals((*this) , b);
-}
-//-------------------------------------------------------------
-bool BigInteger::operator > (BigInteger b)
-{
-	return greater((*this) , b);
-}
-//-------------------------------------------------------------
-bool BigInteger::operator < (BigInteger b)
-{
-	return less((*this) , b);
-}
-//-------------------------------------------------------------
-bool BigInteger::operator >= (BigInteger b)
-{
-	return equals((*this) , b)
-		|| greater((*this), b);
-}
-//-------------------------------------------------------------
-bool BigInteger::operator <= (BigInteger b)
-{
-	return equals((*this) , b) 
-		|| less((*this) , b);
-}
-//-------------------------------------------------------------
-// increments the value, then returns its value
-BigInteger& BigInteger::operator ++() // prefix
-{
-	(*this) = (*this) + 1;
-	return (*this);
-}
-//-------------------------------------------------------------
-// returns the value, then increments its value
-BigInteger BigInteger::operator ++(int) // postfix
-{
-	BigInteger before = (*this);
-
-	(*this) = (*this) + 1;
-
-	return before;
-}
-//-------------------------------------------------------------
-// decrements the value, then return it
-BigInteger& BigInteger::operator --() // prefix
-{
-	(*this) = (*this) - 1;
-	return (*this);
-
-}
-//-------------------------------------------------------------
-// return the value, then decrements it
-BigInteger BigInteger::operator --(int) // postfix
-{	
-	BigInteger before = (*this);
-
-	(*this) = (*this) - 1;
-
-	return before;
-}
-//-------------------------------------------------------------
-BigInteger BigInteger::operator + (BigInteger b)
-{
-	BigInteger addition;
-	if( getSign() == b.getSign() ) // both +ve or -ve
-	{
-		addition.setNumber( add(getNumber(), b.getNumber() ) );
-		addition.setSign( getSign() );
-	}
-	else // sign different
-	{
-		if( absolute() > b.absolute() )
-		{
-			addition.setNumber( subtract(getNumber(), b.getNumber() ) );
-			addition.setSign( getSign() );
-		}
-		else
-		{
-			addition.setNumber( subtract(b.getNumber(), getNumber() ) );
-			addition.setSign( b.getSign() );
-		}
-	}
-	if(addition.getNumber() == "0") // avoid (-0) problem
-		addition.setSign(false);
-
-	return addition;
-}
-//-------------------------------------------------------------
-BigInteger BigInteger::operator - (BigInteger b)
-{
-	b.setSign( ! b.getSign() ); // x - y = x + (-y)
-	return (*this) + b;
-}
-//-------------------------------------------------------------
-BigInteger BigInteger::operator * (BigInteger b)
-{
-	BigInteger mul;
-
-	mul.setNumber( multiply(getNumber(), b.getNumber() ) );
-	mul.setSign( getSign() != b.getSign() );
-
-	if(mul.getNumber() == "0") // avoid (-0) problem
-		mul.setSign(false);
-
-	return mul;
-}
-//-------------------------------------------------------------
-// Warning: Denomerator must be within "long long" size not "BigInteger"
-BigInteger BigInteger::operator / (BigInteger b)
-{
-	long long den = toInt( b.getNumber() );
-	BigInteger div;
-
-	div.setNumber( divide(getNumber(), den).first );
-	div.setSign( getSign() != b.getSign() );
-
-	if(div.getNumber() == "0") // avoid (-0) problem
-		div.setSign(false);
-
-	return div;
-}
-//-------------------------------------------------------------
-// Warning: Denomerator must be within "long long" size not "BigInteger"
-BigInteger BigInteger::operator % (BigInteger b)
-{
-	long long den = toInt( b.getNumber() );
-
-	BigInteger rem;
-	long long rem_int = divide(number, den).second;
-	rem.setNumber( toString(rem_int) );
-	rem.setSign( getSign() != b.getSign() );
-
-	if(rem.getNumber() == "0") // avoid (-0) problem
-		rem.setSign(false);
-
-	return rem;
-}
-//-------------------------------------------------------------
-BigInteger& BigInteger::operator += (BigInteger b)
-{
-	(*this) = (*this) + b;
-	return (*this);
-}
-//-------------------------------------------------------------
-BigInteger& BigInteger::operator -= (BigInteger b)
-{
-	(*this) = (*this) - b;
-	return (*this);
-}
-//-------------------------------------------------------------
-BigInteger& BigInteger::operator *= (BigInteger b)
-{
-	(*this) = (*this) * b;
-	return (*this);
-}
-//-------------------------------------------------------------
-BigInteger& BigInteger::operator /= (BigInteger b)
-{
-	(*this) = (*this) / b;
-	return (*this);
-}
-//-------------------------------------------------------------
-BigInteger& BigInteger::operator %= (BigInteger b)
-{
-	(*this) = (*this) % b;
-	return (*this);
-}
-//-------------------------------------------------------------
-BigInteger& BigInteger::operator [] (int n)
-{
-	return *(this + (n*sizeof(BigInteger)));
-}
-//-------------------------------------------------------------
-BigInteger BigInteger::operator -() // unary minus sign
-{
-	return (*this) * -1;
-}
-//-------------------------------------------------------------
-BigInteger::operator string() // for conversion from BigInteger to string
-{
-	string signedString = ( getSign() ) ? "-" : ""; // if +ve, don't print + sign
-	signedString += number;
-	return signedString;
-}
-//-------------------------------------------------------------
-
-bool BigInteger::equals(BigInteger n1, BigInteger n2)
-{
-	return n1.getNumber() == n2.getNumber()
-		&& n1.getSign() == n2.getSign();
-}
-
-//-------------------------------------------------------------
-bool BigInteger::less(BigInteger n1, BigInteger n2)
-{
-	bool sign1 = n1.getSign();
-	bool sign2 = n2.getSign();
-
-	if(sign1 && ! sign2) // if n1 is -ve and n2 is +ve
-		return true;
-
-	else if(! sign1 && sign2)
-		return false;
-
-	else if(! sign1) // both +ve
-	{
-		if(n1.getNumber().length() < n2.getNumber().length() )
-			return true;
-		if(n1.getNumber().length() > n2.getNumber().length() )
-			return false;
-		return n1.getNumber() < n2.getNumber();
-	}
-	else // both -ve
-	{
-		if(n1.getNumber().length() > n2.getNumber().length())
-			return true;
-		if(n1.getNumber().length() < n2.getNumber().length())
-			return false;
-		return n1.getNumber().compare( n2.getNumber() ) > 0; // greater with -ve sign is LESS
-	}
-}
-//-------------------------------------------------------------
-bool BigInteger::greater(BigInteger n1, BigInteger n2)
-{
-	return ! equals(n1, n2) && ! less(n1, n2);
-}
-
-//-------------------------------------------------------------
-// adds two strings and returns their sum in as a string
-string BigInteger::add(string number1, string number2)
-{
-	string add = (number1.length() > number2.length()) ?  number1 : number2;
-	char carry = '0';
-	int differenceInLength = abs( (int) (number1.size() - number2.size()) );
-
-	if(number1.size() > number2.size())
-		number2.insert(0, differenceInLength, '0'); // put zeros from left
-
-	else// if(number1.size() < number2.size())
-		number1.insert(0, differenceInLength, '0');
-
-	for(int i=number1.size()-1; i>=0; --i)
-	{
-		add[i] = ((carry-'0')+(number1[i]-'0')+(number2[i]-'0')) + '0';
-
-		if(i != 0)
-		{	
-			if(add[i] > '9')
-			{
-				add[i] -= 10;
-				carry = '1';
-			}
-			else
-				carry = '0';
-		}
-	}
-	if(add[0] > '9')
-	{
-		add[0]-= 10;
-		add.insert(0,1,'1');
-	}
-	return add;
-}
-
-//-------------------------------------------------------------
-// subtracts two strings and returns their sum in as a string
-string BigInteger::subtract(string number1, string number2)
-{
-	string sub = (number1.length()>number2.length())? number1 : number2;
-	int differenceInLength = abs( (int)(number1.size() - number2.size()) );
-
-	if(number1.size() > number2.size())	
-		number2.insert(0, differenceInLength, '0');
-
-	else
-		number1.insert(0, differenceInLength, '0');
-
-	for(int i=number1.length()-1; i>=0; --i)
-	{
-		if(number1[i] < number2[i])
-		{
-			number1[i] += 10;
-			number1[i-1]--;
-		}
-		sub[i] = ((number1[i]-'0')-(number2[i]-'0')) + '0';
-	}
-
-	while(sub[0]=='0' && sub.length()!=1) // erase leading zeros
-		sub.erase(0,1);
-
-	return sub;
-}
-
-//-------------------------------------------------------------
-// multiplies two strings and returns their sum in as a string
-string BigInteger::multiply(string n1, string n2)
-{
-	if(n1.length() > n2.length()) 
-		n1.swap(n2);
-
-	string res = "0";
-	for(int i=n1.length()-1; i>=0; --i)
-	{
-		string temp = n2;
-		int currentDigit = n1[i]-'0';
-		int carry = 0;
-
-		for(int j=temp.length()-1; j>=0; --j)
-		{
-			temp[j] = ((temp[j]-'0') * currentDigit) + carry;
-
-			if(temp[j] > 9)
-			{
-				carry = (temp[j]/10);
-				temp[j] -= (carry*10);
-			}
-			else
-				carry = 0;
-
-			temp[j] += '0'; // back to string mood
-		}
-
-		if(carry > 0)
-			temp.insert(0, 1, (carry+'0'));
-		
-		temp.append((n1.length()-i-1), '0'); // as like mult by 10, 100, 1000, 10000 and so on
-
-		res = add(res, temp); // O(n)
-	}
-
-	while(res[0] == '0' && res.length()!=1) // erase leading zeros
-		res.erase(0,1);
-
-	return res;
-}
-
-//-------------------------------------------------------------
-// divides string on long long, returns pair(qutiont, remainder)
-pair<string, long long> BigInteger::divide(string n, long long den)
-{
-	long long rem = 0;
-	string result; result.resize(MAX);
-	
-	for(int indx=0, len = n.length(); indx<len; ++indx)
-	{
-		rem = (rem * 10) + (n[indx] - '0');
-		result[indx] = rem / den + '0';
-		rem %= den;
-	}
-	result.resize( n.length() );
-
-	while( result[0] == '0' && result.length() != 1)
-		result.erase(0,1);
-
-	if(result.length() == 0)
-		result = "0";
-
-	return make_pair(result, rem);
-}
-
-//-------------------------------------------------------------
-// converts long long to string
-string BigInteger::toString(long long n)
-{
-	stringstream ss;
-	string temp;
-
-	ss << n;
-	ss >> temp;
-
-	return temp;
-}
-
-//-------------------------------------------------------------
-// converts string to long long
-long long BigInteger::toInt(string s)
-{
-	long long sum = 0;
-
-	for(int i=0; i<s.length(); i++)
-		sum = (sum*10) + (s[i] - '0');
-
-	return sum;
-}
-
-#endif
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include "BigInteger.h"
+#include "LimbKernels.h"
+#include "NTTMultiply.h"
+
+// largest power of ten that fits in one limb, used for decimal conversion
+static const limb_t DECIMAL_BASE = 10000000000000000000ULL;
+static const int DECIMAL_BASE_DIGITS = 19;
+
+int BigInteger::karatsubaThreshold = 52;
+int BigInteger::toom3Threshold = 140;
+int BigInteger::nttThreshold = 6144;
+int BigInteger::squareThreshold = 100;
+
+
+std::ostream& operator <<(std::ostream& out, const BigInteger& a) {
+    out << (string) a;
+    return out;
+}
+
+
+//-------------------------------------- Constructor -----------------------------------------------------------
+BigInteger::BigInteger() {
+    sign = false;
+}
+
+
+BigInteger::BigInteger(const string& s) {
+    if( isdigit(s[0]) ) {
+        setNumber(s);
+        sign = false; // +ve
+    } else {
+        setNumber( s.substr(1) );
+        sign = (s[0] == '-') && !limbs.empty();
+    }
+}
+
+
+BigInteger::BigInteger(const string& s, bool sin) {
+    setNumber( s );
+    setSign( sin );
+}
+
+
+BigInteger::BigInteger(int n) {
+    // widen before negating so that INT_MIN does not overflow
+    long long value = n;
+    sign = value < 0;
+    if (value < 0)
+        value = -value;
+    if (value != 0)
+        limbs.push_back((limb_t) value);
+}
+
+
+void BigInteger::setNumber(const string& s) {
+    limbs.clear();
+
+    // feed the digits in chunks of 19 so that every step is one limb multiply-add
+    size_t pos = 0;
+    size_t chunk = s.length() % DECIMAL_BASE_DIGITS;
+    if (chunk == 0)
+        chunk = DECIMAL_BASE_DIGITS;
+
+    while (pos < s.length()) {
+        limb_t value = 0;
+        limb_t scale = 1;
+        for (size_t i = pos; i < pos + chunk; i++) {
+            value = value * 10 + (s[i] - '0');
+            scale *= 10;
+        }
+        mulAddLimb(limbs, scale, value);
+        pos += chunk;
+        chunk = DECIMAL_BASE_DIGITS;
+    }
+}
+
+
+string BigInteger::getNumber() const {
+    if (limbs.empty())
+        return "0";
+
+    // peel off 19 decimal digits at a time, least significant chunk first
+    LimbVector rest = limbs;
+    LimbVector chunks;
+    while (!rest.empty())
+        chunks.push_back(divideByLimb(rest, DECIMAL_BASE));
+
+    string s = to_string(chunks.back());
+    for (int i = (int) chunks.size() - 2; i >= 0; --i) {
+        string part = to_string(chunks[i]);
+        s.append(DECIMAL_BASE_DIGITS - part.length(), '0');
+        s += part;
+    }
+    return s;
+}
+
+
+void BigInteger::setLimbs(LimbVector l) {
+    limbs = std::move(l);
+    trim(limbs);
+}
+
+
+const LimbVector& BigInteger::getLimbs() const {
+    return limbs;
+}
+
+
+void BigInteger::setSign(bool s) {
+    sign = s;
+}
+
+
+const bool& BigInteger::getSign() const {
+    return sign;
+}
+
+
+BigInteger BigInteger::absolute() const {
+    BigInteger abs = (*this);
+    abs.sign = false;
+    return abs;
+}
+
+
+bool BigInteger::isEven() const {
+    return limbs.empty() || (limbs[0] & 1) == 0;
+}
+
+
+bool BigInteger::isOdd() const {
+    return !isEven();
+}
+
+
+limb_t BigInteger::modLimb(limb_t d) const {
+    if (d == 0)
+        throw domain_error("BigInteger: division by zero");
+    // a power of two is a mask on the lowest limb
+    if ((d & (d - 1)) == 0)
+        return limbs.empty() ? 0 : limbs[0] & (d - 1);
+    return mpn_mod_1(limbs.data(), limbs.size(), d);
+}
+
+
+bool BigInteger::divisibleBy(limb_t d) const {
+    return modLimb(d) == 0;
+}
+
+
+//-------------------------------------- Bits -----------------------------------------------------------------
+bool BigInteger::testBit(size_t i) const {
+    return i / 64 < limbs.size() && ((limbs[i / 64] >> (i % 64)) & 1);
+}
+
+
+void BigInteger::setBit(size_t i) {
+    if (limbs.size() <= i / 64)
+        limbs.resize(i / 64 + 1, 0);
+    limbs[i / 64] |= (limb_t) 1 << (i % 64);
+}
+
+
+size_t BigInteger::bitLength() const {
+    if (limbs.empty())
+        return 0;
+    return limbs.size() * 64 - __builtin_clzll(limbs.back());
+}
+
+
+size_t BigInteger::countTrailingZeros() const {
+    for (size_t i = 0; i < limbs.size(); i++) {
+        if (limbs[i] != 0)
+            return i * 64 + __builtin_ctzll(limbs[i]);
+    }
+    return 0;
+}
+
+
+size_t BigInteger::popcount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < limbs.size(); i++)
+        count += __builtin_popcountll(limbs[i]);
+    return count;
+}
+
+
+//-------------------------------------- Operators ------------------------------------------------------------
+bool BigInteger::operator == (const BigInteger& b) const {
+    return equals((*this) , b);
+}
+
+
+bool BigInteger::operator != (const BigInteger& b) const {
+    return ! equals((*this) , b);
+}
+
+
+bool BigInteger::operator > (const BigInteger& b) const {
+    return greater((*this) , b);
+}
+
+
+bool BigInteger::operator < (const BigInteger& b) const {
+    return less((*this) , b);
+}
+
+
+bool BigInteger::operator >= (const BigInteger& b) const {
+    return ! less((*this), b);
+}
+
+
+bool BigInteger::operator <= (const BigInteger& b) const {
+    return ! greater((*this), b);
+}
+
+
+BigInteger& BigInteger::operator ++() {
+    (*this) += 1;
+    return (*this);
+}
+
+
+BigInteger BigInteger::operator ++(int) {
+    BigInteger before = (*this);
+
+    (*this) += 1;
+
+    return before;
+}
+
+
+BigInteger& BigInteger::operator --() {
+    (*this) -= 1;
+    return (*this);
+
+}
+
+
+BigInteger BigInteger::operator --(int) {
+    BigInteger before = (*this);
+    (*this) -= 1;
+    return before;
+}
+
+
+BigInteger BigInteger::operator + (const BigInteger& b) const & {
+    BigInteger addition = (*this);
+    addition += b;
+    return addition;
+}
+
+
+BigInteger BigInteger::operator + (const BigInteger& b) && {
+    (*this) += b;
+    return std::move(*this);
+}
+
+
+BigInteger BigInteger::operator - (const BigInteger& b) const & {
+    BigInteger subtraction = (*this);
+    subtraction -= b;
+    return subtraction;
+}
+
+
+BigInteger BigInteger::operator - (const BigInteger& b) && {
+    (*this) -= b;
+    return std::move(*this);
+}
+
+
+BigInteger BigInteger::operator * (const BigInteger& b) const & {
+    BigInteger mul;
+
+    mul.limbs = multiply(limbs, b.limbs);
+    mul.sign = (sign != b.sign) && !mul.limbs.empty();
+
+    return mul;
+}
+
+
+BigInteger BigInteger::operator * (const BigInteger& b) && {
+    (*this) *= b;
+    return std::move(*this);
+}
+
+
+BigInteger BigInteger::operator / (const BigInteger& b) const & {
+    return divide((*this), b).first;
+}
+
+
+BigInteger BigInteger::operator / (const BigInteger& b) && {
+    (*this) /= b;
+    return std::move(*this);
+}
+
+
+BigInteger BigInteger::operator % (const BigInteger& b) const & {
+    // a one-limb divisor needs no quotient, only a single pass with its reciprocal
+    if (b.limbs.size() == 1)
+        return fromMagnitude(LimbVector(1, modLimb(b.limbs[0])), sign);
+    return divide((*this), b).second;
+}
+
+
+BigInteger BigInteger::operator % (const BigInteger& b) && {
+    (*this) %= b;
+    return std::move(*this);
+}
+
+
+BigInteger& BigInteger::operator += (const BigInteger& b) {
+    addSigned(b.limbs, b.sign);
+    return (*this);
+}
+
+
+BigInteger& BigInteger::operator -= (const BigInteger& b) {
+    addSigned(b.limbs, !b.sign);
+    return (*this);
+}
+
+
+BigInteger& BigInteger::operator *= (const BigInteger& b) {
+    limbs = multiply(limbs, b.limbs);
+    sign = (sign != b.sign) && !limbs.empty();
+    return (*this);
+}
+
+
+BigInteger& BigInteger::operator /= (const BigInteger& b) {
+    LimbVector quotient, remainder;
+    divideMagnitude(limbs, b.limbs, quotient, remainder);
+    limbs.swap(quotient);
+    sign = (sign != b.sign) && !limbs.empty();
+    return (*this);
+}
+
+
+BigInteger& BigInteger::operator %= (const BigInteger& b) {
+    if (b.limbs.size() == 1) {
+        limb_t rem = modLimb(b.limbs[0]);
+        limbs.clear();
+        if (rem != 0)
+            limbs.push_back(rem);
+        sign = sign && !limbs.empty();
+        return (*this);
+    }
+
+    LimbVector quotient, remainder;
+    divideMagnitude(limbs, b.limbs, quotient, remainder);
+    limbs.swap(remainder);
+    sign = sign && !limbs.empty();
+    return (*this);
+}
+
+
+BigInteger BigInteger::operator << (size_t bits) const {
+    BigInteger shifted = (*this);
+    shifted <<= bits;
+    return shifted;
+}
+
+
+BigInteger BigInteger::operator >> (size_t bits) const {
+    BigInteger shifted = (*this);
+    shifted >>= bits;
+    return shifted;
+}
+
+
+BigInteger& BigInteger::operator <<= (size_t bits) {
+    if (limbs.empty())
+        return (*this);
+    limb_t out = mpn_lshift(limbs.data(), limbs.data(), limbs.size(), bits % 64);
+    if (out != 0)
+        limbs.push_back(out);
+    if (bits >= 64)
+        limbs.insert(limbs.begin(), bits / 64, 0);
+    return (*this);
+}
+
+
+BigInteger& BigInteger::operator >>= (size_t bits) {
+    if (bits / 64 >= limbs.size()) {
+        limbs.clear();
+    } else {
+        limbs.erase(limbs.begin(), limbs.begin() + bits / 64);
+        mpn_rshift(limbs.data(), limbs.data(), limbs.size(), bits % 64);
+        trim(limbs);
+    }
+    sign = sign && !limbs.empty();
+    return (*this);
+}
+
+
+BigInteger BigInteger::operator & (const BigInteger& b) const {
+    BigInteger res;
+    res.limbs.resize(min(limbs.size(), b.limbs.size()));
+    for (size_t i = 0; i < res.limbs.size(); i++)
+        res.limbs[i] = limbs[i] & b.limbs[i];
+    trim(res.limbs);
+    return res;
+}
+
+
+BigInteger BigInteger::operator | (const BigInteger& b) const {
+    const LimbVector& longer = limbs.size() >= b.limbs.size() ? limbs : b.limbs;
+    const LimbVector& shorter = limbs.size() >= b.limbs.size() ? b.limbs : limbs;
+    BigInteger res;
+    res.limbs = longer;
+    for (size_t i = 0; i < shorter.size(); i++)
+        res.limbs[i] |= shorter[i];
+    return res;
+}
+
+
+BigInteger BigInteger::operator ^ (const BigInteger& b) const {
+    const LimbVector& longer = limbs.size() >= b.limbs.size() ? limbs : b.limbs;
+    const LimbVector& shorter = limbs.size() >= b.limbs.size() ? b.limbs : limbs;
+    BigInteger res;
+    res.limbs = longer;
+    for (size_t i = 0; i < shorter.size(); i++)
+        res.limbs[i] ^= shorter[i];
+    trim(res.limbs);
+    return res;
+}
+
+
+BigInteger& BigInteger::operator [] (int n) {
+    return *(this + (n*sizeof(BigInteger)));
+}
+
+
+BigInteger BigInteger::operator -() const & {
+    BigInteger neg = (*this);
+    neg.sign = !sign && !limbs.empty();
+    return neg;
+}
+
+
+BigInteger BigInteger::operator -() && {
+    sign = !sign && !limbs.empty();
+    return std::move(*this);
+}
+
+
+BigInteger::operator string() const { // for conversion from BigInteger to string
+    string signedString = ( getSign() ) ? "-" : "";
+    signedString += getNumber();
+    return signedString;
+}
+
+
+bool BigInteger::equals(const BigInteger& n1, const BigInteger& n2) {
+    return n1.sign == n2.sign
+           && compare(n1.limbs, n2.limbs) == 0;
+}
+
+
+bool BigInteger::less(const BigInteger& n1, const BigInteger& n2) {
+    bool sign1 = n1.sign;
+    bool sign2 = n2.sign;
+
+    if(sign1 && ! sign2) // if n1 is -ve and n2 is +ve
+        return true;
+
+    else if(! sign1 && sign2)
+        return false;
+
+    else if(! sign1) // both +ve
+        return compare(n1.limbs, n2.limbs) < 0;
+    else // both -ve
+        return compare(n1.limbs, n2.limbs) > 0;
+}
+
+
+bool BigInteger::greater(const BigInteger& n1, const BigInteger& n2) {
+    return less(n2, n1);
+}
+
+
+// (*this) += (bSign ? -b : b) without a temporary
+void BigInteger::addSigned(const LimbVector& b, bool bSign) {
+    if (sign == bSign) {
+        addInPlace(limbs, b);
+    } else if (compare(limbs, b) >= 0) {
+        subtractInPlace(limbs, b);
+    } else {
+        subtractFromInPlace(limbs, b);
+        sign = bSign;
+    }
+    if (limbs.empty())
+        sign = false;
+}
+
+
+void BigInteger::setMultiplyThresholds(int karatsuba, int toom3, int ntt) {
+    karatsubaThreshold = karatsuba;
+    toom3Threshold = toom3;
+    nttThreshold = ntt;
+}
+
+
+void BigInteger::setSquareThreshold(int karatsuba) {
+    squareThreshold = karatsuba;
+}
+
+
+//-------------------------------------- Limb arithmetic ------------------------------------------------------
+// drops leading zero limbs so that zero is the empty vector
+void BigInteger::trim(LimbVector& a) {
+    while (!a.empty() && a.back() == 0)
+        a.pop_back();
+}
+
+
+// compares two magnitudes, returns -1, 0 or 1
+int BigInteger::compare(const LimbVector& a, const LimbVector& b) {
+    if (a.size() != b.size())
+        return a.size() < b.size() ? -1 : 1;
+    return mpn_cmp(a.data(), b.data(), a.size());
+}
+
+
+LimbVector BigInteger::add(const LimbVector& a, const LimbVector& b) {
+    const LimbVector& longer = a.size() >= b.size() ? a : b;
+    const LimbVector& shorter = a.size() >= b.size() ? b : a;
+
+    LimbVector sum(longer.size() + 1);
+    sum[longer.size()] = mpn_add(sum.data(), longer.data(), longer.size(), shorter.data(), shorter.size());
+    trim(sum);
+    return sum;
+}
+
+
+// subtracts two magnitudes, a must not be smaller than b
+LimbVector BigInteger::subtract(const LimbVector& a, const LimbVector& b) {
+    LimbVector diff(a.size());
+    mpn_sub(diff.data(), a.data(), a.size(), b.data(), b.size());
+    trim(diff);
+    return diff;
+}
+
+
+// a += b; b may be a itself
+void BigInteger::addInPlace(LimbVector& a, const LimbVector& b) {
+    if (a.size() < b.size())
+        a.resize(b.size(), 0);
+    limb_t carry = mpn_add(a.data(), a.data(), a.size(), b.data(), b.size());
+    if (carry != 0)
+        a.push_back(carry);
+}
+
+
+// a -= b, a must not be smaller than b
+void BigInteger::subtractInPlace(LimbVector& a, const LimbVector& b) {
+    mpn_sub(a.data(), a.data(), a.size(), b.data(), b.size());
+    trim(a);
+}
+
+
+// a = b - a, b must not be smaller than a
+void BigInteger::subtractFromInPlace(LimbVector& a, const LimbVector& b) {
+    size_t n = a.size();
+    a.resize(b.size(), 0);
+    mpn_sub(a.data(), b.data(), b.size(), a.data(), n);
+    trim(a);
+}
+
+
+LimbVector BigInteger::multiply(const LimbVector& a, const LimbVector& b) {
+    if (&a == &b)
+        return square(a);
+    if (a.empty() || b.empty())
+        return LimbVector();
+
+    const LimbVector& longer = a.size() >= b.size() ? a : b;
+    const LimbVector& shorter = a.size() >= b.size() ? b : a;
+
+    // Karatsuba needs two limbs and Toom-3 three to split into smaller pieces, whatever
+    // the thresholds say
+    if (shorter.size() < 2 || (int) shorter.size() < karatsubaThreshold)
+        return multiplySchoolbook(longer, shorter);
+    if (2 * shorter.size() <= longer.size())
+        return multiplyUnbalanced(longer, shorter);
+    if ((int) shorter.size() >= nttThreshold)
+        return nttMultiply(longer, shorter);
+    if (shorter.size() < 3 || (int) shorter.size() < toom3Threshold)
+        return multiplyKaratsuba(longer, shorter);
+    return multiplyToom3(longer, shorter);
+}
+
+
+// the Toom-3 and NTT ranges reuse the general multiplication
+LimbVector BigInteger::square(const LimbVector& a) {
+    if (a.empty())
+        return LimbVector();
+
+    if (a.size() < 2 || (int) a.size() < squareThreshold) {
+        LimbVector res(2 * a.size());
+        mpn_sqr_basecase(res.data(), a.data(), a.size());
+        trim(res);
+        return res;
+    }
+    if ((int) a.size() >= nttThreshold)
+        return nttMultiply(a, a);
+    if (a.size() < 3 || (int) a.size() < toom3Threshold)
+        return squareKaratsuba(a);
+    return multiplyToom3(a, a);
+}
+
+
+LimbVector BigInteger::multiplySchoolbook(const LimbVector& a, const LimbVector& b) {
+    LimbVector res(a.size() + b.size());
+    mpn_mul_basecase(res.data(), a.data(), a.size(), b.data(), b.size());
+    trim(res);
+    return res;
+}
+
+
+// cuts the longer operand into pieces the size of the shorter one so that every
+// partial product is balanced enough for Karatsuba or Toom-3
+LimbVector BigInteger::multiplyUnbalanced(const LimbVector& longer, const LimbVector& shorter) {
+    LimbVector res(longer.size() + shorter.size() + 1, 0);
+    for (size_t offset = 0; offset < longer.size(); offset += shorter.size()) {
+        LimbVector piece = slice(longer, offset, shorter.size());
+        addShifted(res, multiply(piece, shorter), offset);
+    }
+    trim(res);
+    return res;
+}
+
+
+// a = a1*B^k + a0, b = b1*B^k + b0
+// a*b = z2*B^2k + ((a0+a1)(b0+b1) - z2 - z0)*B^k + z0
+LimbVector BigInteger::multiplyKaratsuba(const LimbVector& a, const LimbVector& b) {
+    size_t k = (max(a.size(), b.size()) + 1) / 2;
+    LimbVector a0 = slice(a, 0, k), a1 = slice(a, k, a.size());
+    LimbVector b0 = slice(b, 0, k), b1 = slice(b, k, b.size());
+
+    LimbVector z0 = multiply(a0, b0);
+    LimbVector z2 = multiply(a1, b1);
+    LimbVector z1 = multiply(add(a0, a1), add(b0, b1));
+    z1 = subtract(subtract(z1, z0), z2);
+
+    LimbVector res(a.size() + b.size() + 1, 0);
+    addShifted(res, z0, 0);
+    addShifted(res, z1, k);
+    addShifted(res, z2, 2 * k);
+    trim(res);
+    return res;
+}
+
+
+// a = a1*B^k + a0
+// a^2 = a1^2*B^2k + ((a0+a1)^2 - a1^2 - a0^2)*B^k + a0^2, three half-size squares
+LimbVector BigInteger::squareKaratsuba(const LimbVector& a) {
+    size_t k = (a.size() + 1) / 2;
+    LimbVector a0 = slice(a, 0, k), a1 = slice(a, k, a.size());
+
+    LimbVector z0 = square(a0);
+    LimbVector z2 = square(a1);
+    LimbVector z1 = square(add(a0, a1));
+    z1 = subtract(subtract(z1, z0), z2);
+
+    LimbVector res(2 * a.size() + 1, 0);
+    addShifted(res, z0, 0);
+    addShifted(res, z1, k);
+    addShifted(res, z2, 2 * k);
+    trim(res);
+    return res;
+}
+
+
+// Toom-Cook 3-way split evaluated at 0, 1, -1, -2 and infinity, interpolated with
+// Bodrato's sequence; the evaluations can go negative so they are kept as signed BigIntegers
+LimbVector BigInteger::multiplyToom3(const LimbVector& a, const LimbVector& b) {
+    size_t k = (max(a.size(), b.size()) + 2) / 3;
+    BigInteger a0 = fromMagnitude(slice(a, 0, k), false);
+    BigInteger a1 = fromMagnitude(slice(a, k, k), false);
+    BigInteger a2 = fromMagnitude(slice(a, 2 * k, a.size()), false);
+    BigInteger b0 = fromMagnitude(slice(b, 0, k), false);
+    BigInteger b1 = fromMagnitude(slice(b, k, k), false);
+    BigInteger b2 = fromMagnitude(slice(b, 2 * k, b.size()), false);
+
+    BigInteger pa = a0 + a2, pb = b0 + b2;
+    BigInteger aOne = pa + a1, bOne = pb + b1;
+    BigInteger aMinusOne = pa - a1, bMinusOne = pb - b1;
+    BigInteger aMinusTwo = aMinusOne + a2, bMinusTwo = bMinusOne + b2;
+    aMinusTwo = aMinusTwo + aMinusTwo - a0;
+    bMinusTwo = bMinusTwo + bMinusTwo - b0;
+
+    // when squaring, pairing each evaluation of a with itself lets every product run as a square
+    bool squaring = &a == &b;
+    BigInteger r0 = a0 * (squaring ? a0 : b0);
+    BigInteger r1 = aOne * (squaring ? aOne : bOne);
+    BigInteger rMinusOne = aMinusOne * (squaring ? aMinusOne : bMinusOne);
+    BigInteger rMinusTwo = aMinusTwo * (squaring ? aMinusTwo : bMinusTwo);
+    BigInteger rInf = a2 * (squaring ? a2 : b2);
+
+    // the divisions below are exact, so dividing the magnitude keeps the sign right
+    BigInteger r3 = rMinusTwo - r1;
+    divideByLimb(r3.limbs, 3);
+    r1 = r1 - rMinusOne;
+    r1 >>= 1;
+    BigInteger r2 = rMinusOne - r0;
+    r3 = r2 - r3;
+    r3 >>= 1;
+    r3 = r3 + rInf + rInf;
+    r2 = r2 + r1 - rInf;
+    r1 = r1 - r3;
+
+    // every coefficient of a product of non-negative polynomials is non-negative
+    LimbVector res(a.size() + b.size() + 1, 0);
+    addShifted(res, r0.limbs, 0);
+    addShifted(res, r1.limbs, k);
+    addShifted(res, r2.limbs, 2 * k);
+    addShifted(res, r3.limbs, 3 * k);
+    addShifted(res, rInf.limbs, 4 * k);
+    trim(res);
+    return res;
+}
+
+
+// copies up to length limbs of a starting at from
+LimbVector BigInteger::slice(const LimbVector& a, size_t from, size_t length) {
+    if (from >= a.size())
+        return LimbVector();
+    size_t to = min(a.size(), from + length);
+    LimbVector part(a.begin() + from, a.begin() + to);
+    trim(part);
+    return part;
+}
+
+
+// res += a * B^offset, growing res if the carry runs off the end
+void BigInteger::addShifted(LimbVector& res, const LimbVector& a, size_t offset) {
+    if (res.size() < offset + a.size())
+        res.resize(offset + a.size(), 0);
+
+    limb_t* r = res.data() + offset;
+    limb_t carry = mpn_add(r, r, res.size() - offset, a.data(), a.size());
+    if (carry != 0)
+        res.push_back(carry);
+}
+
+
+BigInteger BigInteger::fromMagnitude(const LimbVector& a, bool sign) {
+    BigInteger n;
+    n.limbs = a;
+    trim(n.limbs);
+    n.sign = sign && !n.limbs.empty();
+    return n;
+}
+
+
+// a = a * m + c
+void BigInteger::mulAddLimb(LimbVector& a, limb_t m, limb_t c) {
+    // a * m + c < 2^64 * 2^(64 n), so the two carries cannot overflow one limb
+    limb_t carry = mpn_mul_1(a.data(), a.data(), a.size(), m);
+    carry += mpn_add_1(a.data(), a.data(), a.size(), c);
+    if (carry != 0)
+        a.push_back(carry);
+    trim(a);
+}
+
+
+// divides a by d in place and returns the remainder
+limb_t BigInteger::divideByLimb(LimbVector& a, limb_t d) {
+    limb_t rem = mpn_divrem_1(a.data(), a.data(), a.size(), d);
+    trim(a);
+    return rem;
+}
+
+
+// Knuth's Algorithm D (TAOCP 4.3.1): u / v for v of at least two limbs and u >= v.
+// Both operands are shifted so the divisor's top bit is set, which keeps each
+// two-limb quotient estimate at most two above the true quotient limb.
+void BigInteger::divideKnuth(const LimbVector& u, const LimbVector& v,
+                             LimbVector& quotient, LimbVector& remainder) {
+    size_t n = v.size(), m = u.size() - v.size();
+    int shift = __builtin_clzll(v.back());
+
+    LimbVector vn(n), un(u.size() + 1);
+    mpn_lshift(vn.data(), v.data(), n, shift);
+    un[u.size()] = mpn_lshift(un.data(), u.data(), u.size(), shift);
+
+    quotient.assign(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0; ) {
+        // estimate the quotient limb from the top two limbs and refine it with the third
+        dlimb_t numerator = ((dlimb_t) un[j + n] << 64) | un[j + n - 1];
+        dlimb_t qhat = numerator / vn[n - 1];
+        dlimb_t rhat = numerator % vn[n - 1];
+        while ((qhat >> 64) != 0
+               || (dlimb_t) (limb_t) qhat * vn[n - 2] > ((rhat << 64) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if ((rhat >> 64) != 0)
+                break;
+        }
+
+        // un[j .. j+n] -= qhat * vn
+        limb_t q = (limb_t) qhat;
+        limb_t borrow = mpn_submul_1(un.data() + j, vn.data(), n, q);
+        limb_t top = un[j + n];
+        un[j + n] = top - borrow;
+
+        // the estimate was one too large: add the divisor back
+        if (top < borrow) {
+            q--;
+            un[j + n] += mpn_add_n(un.data() + j, un.data() + j, vn.data(), n);
+        }
+        quotient[j] = q;
+    }
+    trim(quotient);
+
+    // undo the normalization on what is left; it is below vn, so un[n] is already zero
+    remainder.assign(n, 0);
+    mpn_rshift(remainder.data(), un.data(), n, shift);
+    trim(remainder);
+}
+
+
+// u = quotient * v + remainder on magnitudes
+void BigInteger::divideMagnitude(const LimbVector& u, const LimbVector& v,
+                                 LimbVector& quotient, LimbVector& remainder) {
+    if (v.empty())
+        throw domain_error("BigInteger: division by zero");
+
+    if (v.size() == 1) {
+        quotient.resize(u.size());
+        limb_t rem = mpn_divrem_1(quotient.data(), u.data(), u.size(), v[0]);
+        trim(quotient);
+        remainder.clear();
+        if (rem != 0)
+            remainder.push_back(rem);
+    } else if (compare(u, v) < 0) {
+        quotient.clear();
+        remainder = u;
+    } else {
+        divideKnuth(u, v, quotient, remainder);
+    }
+}
+
+
+// truncating division: the quotient is rounded toward zero and the remainder keeps the dividend's sign
+pair<BigInteger, BigInteger> BigInteger::divide(const BigInteger& dividend, const BigInteger& divisor) {
+    BigInteger quotient, remainder;
+    divideMagnitude(dividend.limbs, divisor.limbs, quotient.limbs, remainder.limbs);
+
+    quotient.sign = (dividend.sign != divisor.sign) && !quotient.limbs.empty();
+    remainder.sign = dividend.sign && !remainder.limbs.empty();
+    return make_pair(quotient, remainder);
+}
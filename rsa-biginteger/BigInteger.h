@@ -1,56 +1,145 @@
+#ifndef BIGINTEGER_H
+#define BIGINTEGER_H
+
+#include <cstdint>
+#include <iostream>
 #include <string>
-#define MAX 10000 // for strings
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "LimbVector.h"
 
 using namespace std;
+
 //-------------------------------------------------------------
-class BigInteger
-{
+class BigInteger {
 private:
-	string number;
-	bool sign;
+    static int karatsubaThreshold;
+    static int toom3Threshold;
+    static int nttThreshold;
+    static int squareThreshold;
+
+    LimbVector limbs; // magnitude, least significant limb first, no leading zero limbs
+    bool sign;
+
 public:
-	BigInteger(); // empty constructor initializes zero
-	BigInteger(string s); // "string" constructor
-	BigInteger(string s, bool sin); // "string" constructor
-	BigInteger(int n); // "int" constructor
-	void setNumber(string s);
-	const string& getNumber(); // retrieves the number
-	void setSign(bool s);
-	const bool& getSign();
-	BigInteger absolute(); // returns the absolute value
-	void operator = (BigInteger b);
-	bool operator == (BigInteger b);
-	bool operator != (BigInteger b);
-	bool operator > (BigInteger b);
-	bool operator < (BigInteger b);
-	bool operator >= (BigInteger b);
-	bool operator <= (BigInteger b);
-	BigInteger& operator ++(); // prefix
-	BigInteger  operator ++(int); // postfix
-	BigInteger& operator --(); // prefix
-	BigInteger  operator --(int); // postfix
-	BigInteger operator + (BigInteger b);
-	BigInteger operator - (BigInteger b);
-	BigInteger operator * (BigInteger b);
-	BigInteger operator / (BigInteger b);
-	BigInteger operator % (BigInteger b);
-	BigInteger& operator += (BigInteger b);
-	BigInteger& operator -= (BigInteger b);
-	BigInteger& operator *= (BigInteger b);
-	BigInteger& operator /= (BigInteger b);
-	BigInteger& operator %= (BigInteger b);
-	BigInteger& operator [] (int n);
-	BigInteger operator -(); // unary minus sign
-	operator string(); // for conversion from BigInteger to string
+    BigInteger(); // empty constructor initializes zero
+    BigInteger(const string& s); // "string" constructor
+    BigInteger(const string& s, bool sin); // "string" constructor
+    BigInteger(int n); // "int" constructor
+    BigInteger(const BigInteger& b) = default;
+    BigInteger(BigInteger&& b) = default; // takes over b's limbs without copying
+
+    void setNumber(const string& s); // parses decimal digits into limbs
+    string getNumber() const; // decimal digits of the magnitude, built on demand
+    void setLimbs(LimbVector l); // magnitude as base 2^64 limbs, least significant first
+    const LimbVector& getLimbs() const;
+    void setSign(bool s);
+    const bool& getSign() const;
+    BigInteger absolute() const; // returns the absolute value
+
+    // parity and remainders by a single limb, none of which allocates
+    bool isEven() const;
+    bool isOdd() const;
+    limb_t modLimb(limb_t d) const; // |this| mod d, d != 0
+    bool divisibleBy(limb_t d) const; // d != 0
+
+    // bit operations on the magnitude: shifts keep the sign (so >> truncates toward
+    // zero), & | ^ give non-negative results
+    bool testBit(size_t i) const;
+    void setBit(size_t i);
+    size_t bitLength() const; // 0 for zero
+    size_t countTrailingZeros() const; // 0 for zero
+    size_t popcount() const;
+
+    BigInteger& operator = (const BigInteger& b) = default;
+    BigInteger& operator = (BigInteger&& b) = default;
+    bool operator == (const BigInteger& b) const;
+    bool operator != (const BigInteger& b) const;
+    bool operator > (const BigInteger& b) const;
+    bool operator < (const BigInteger& b) const;
+    bool operator >= (const BigInteger& b) const;
+    bool operator <= (const BigInteger& b) const;
+
+    // the && overloads run on a temporary left operand in place and hand its
+    // limbs on to the result, so x = (x * y) % mod allocates one buffer, not three
+    BigInteger& operator ++(); // prefix
+    BigInteger  operator ++(int); // postfix
+    BigInteger& operator --(); // prefix
+    BigInteger  operator --(int); // postfix
+    BigInteger operator + (const BigInteger& b) const &;
+    BigInteger operator + (const BigInteger& b) &&;
+    BigInteger operator - (const BigInteger& b) const &;
+    BigInteger operator - (const BigInteger& b) &&;
+    BigInteger operator * (const BigInteger& b) const &;
+    BigInteger operator * (const BigInteger& b) &&;
+    BigInteger operator / (const BigInteger& b) const &;
+    BigInteger operator / (const BigInteger& b) &&;
+    BigInteger operator % (const BigInteger& b) const &;
+    BigInteger operator % (const BigInteger& b) &&;
+    BigInteger& operator += (const BigInteger& b);
+    BigInteger& operator -= (const BigInteger& b);
+    BigInteger& operator *= (const BigInteger& b);
+    BigInteger& operator /= (const BigInteger& b);
+    BigInteger& operator %= (const BigInteger& b);
+    BigInteger operator << (size_t bits) const;
+    BigInteger operator >> (size_t bits) const;
+    BigInteger& operator <<= (size_t bits);
+    BigInteger& operator >>= (size_t bits);
+    BigInteger operator & (const BigInteger& b) const;
+    BigInteger operator | (const BigInteger& b) const;
+    BigInteger operator ^ (const BigInteger& b) const;
+    BigInteger& operator [] (int n);
+    BigInteger operator -() const &; // unary minus sign
+    BigInteger operator -() &&;
+
+    operator string() const; // for conversion from BigInteger to string
+    friend std::ostream& operator<<(std::ostream& out, const BigInteger& a);
+
+    // operand sizes in limbs where multiply() moves from schoolbook to Karatsuba,
+    // from Karatsuba to Toom-3 and from Toom-3 to NTT; the defaults come from rsa_benchmark
+    static void setMultiplyThresholds(int karatsuba, int toom3, int ntt);
+    // size where square() moves from the triangular schoolbook square to Karatsuba;
+    // later than for multiply() since the schoolbook square does half the products
+    static void setSquareThreshold(int karatsuba);
+
+    // magnitude arithmetic on trimmed limb vectors, for helpers that work below BigInteger
+    static void trim(LimbVector& a);
+    static int compare(const LimbVector& a, const LimbVector& b);
+    static LimbVector add(const LimbVector& a, const LimbVector& b);
+    static LimbVector subtract(const LimbVector& a, const LimbVector& b); // a >= b
+    static void addInPlace(LimbVector& a, const LimbVector& b);
+    static void subtractInPlace(LimbVector& a, const LimbVector& b); // a >= b
+    static LimbVector multiply(const LimbVector& a, const LimbVector& b); // squares when a is b
+    static LimbVector square(const LimbVector& a);
+    static void divideMagnitude(const LimbVector& u, const LimbVector& v,
+                                LimbVector& quotient, LimbVector& remainder); // v != 0
+
 private:
-	bool equals(BigInteger n1, BigInteger n2);
-	bool less(BigInteger n1, BigInteger n2);
-	bool greater(BigInteger n1, BigInteger n2);
-	string add(string number1, string number2);
-	string subtract(string number1, string number2);
-	string multiply(string n1, string n2);
-	pair<string, long long> divide(string n, long long den);
-	string toString(long long n);
-	long long toInt(string s);
+    static bool equals(const BigInteger& n1, const BigInteger& n2);
+    static bool less(const BigInteger& n1, const BigInteger& n2);
+    static bool greater(const BigInteger& n1, const BigInteger& n2);
+
+    void addSigned(const LimbVector& b, bool bSign);
+    static void subtractFromInPlace(LimbVector& a, const LimbVector& b);
+
+    static LimbVector multiplySchoolbook(const LimbVector& a, const LimbVector& b);
+    static LimbVector multiplyUnbalanced(const LimbVector& longer, const LimbVector& shorter);
+    static LimbVector multiplyKaratsuba(const LimbVector& a, const LimbVector& b);
+    static LimbVector multiplyToom3(const LimbVector& a, const LimbVector& b);
+    static LimbVector squareKaratsuba(const LimbVector& a);
+    static LimbVector slice(const LimbVector& a, size_t from, size_t length);
+    static void addShifted(LimbVector& res, const LimbVector& a, size_t offset);
+    static BigInteger fromMagnitude(const LimbVector& a, bool sign);
+    static void mulAddLimb(LimbVector& a, limb_t m, limb_t c);
+    static limb_t divideByLimb(LimbVector& a, limb_t d);
+    static void divideKnuth(const LimbVector& u, const LimbVector& v,
+                            LimbVector& quotient, LimbVector& remainder);
+    static pair<BigInteger, BigInteger> divide(const BigInteger& dividend, const BigInteger& divisor);
 };
 
+// vector<BigInteger> only moves its elements on growth when moving cannot throw
+static_assert(is_nothrow_move_constructible<BigInteger>::value, "BigInteger: move constructor must be noexcept");
+static_assert(is_nothrow_move_assignable<BigInteger>::value, "BigInteger: move assignment must be noexcept");
+
+#endif
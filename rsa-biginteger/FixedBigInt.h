@@ -0,0 +1,386 @@
+#ifndef FIXEDBIGINT_H
+#define FIXEDBIGINT_H
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "BigInteger.h"
+#include "LimbKernels.h"
+#include "MontgomeryContext.h"
+#include "SlidingWindow.h"
+#include "VectorMontgomery.h"
+
+//-------------------------------------------------------------
+// Non-negative integer of exactly Bits bits in a std::array of limbs, least significant
+// first, for key sizes known at compile time. Arithmetic wraps modulo 2^Bits like the
+// built-in unsigned types, the limb loops run over the constant LIMBS so the compiler
+// can unroll them, and no arithmetic allocates; only conversions to and from BigInteger
+// do. The operators and bit functions follow
+// BigInteger's, so code written against the shared subset instantiates for both.
+template <size_t Bits>
+class FixedBigInt {
+    static_assert(Bits % 64 == 0 && Bits > 0, "FixedBigInt: Bits must be a positive multiple of 64");
+
+public:
+    static const size_t LIMBS = Bits / 64;
+
+private:
+    array<limb_t, LIMBS> limbs;
+
+public:
+    constexpr FixedBigInt() : limbs() {}
+    constexpr FixedBigInt(limb_t n) : limbs{{n}} {}
+    explicit FixedBigInt(const BigInteger& b); // b non-negative and at most Bits long
+    explicit FixedBigInt(const string& s) : FixedBigInt(BigInteger(s)) {}
+    template <size_t Other>
+    explicit FixedBigInt(const FixedBigInt<Other>& b); // widens, or keeps the low Bits
+
+    BigInteger toBigInteger() const;
+    string getNumber() const { return toBigInteger().getNumber(); }
+
+    limb_t* data() { return limbs.data(); }
+    const limb_t* data() const { return limbs.data(); }
+    limb_t limb(size_t i) const { return limbs[i]; }
+
+    bool isZero() const;
+    bool isEven() const { return (limbs[0] & 1) == 0; }
+    bool isOdd() const { return (limbs[0] & 1) != 0; }
+    bool testBit(size_t i) const { return i < Bits && ((limbs[i / 64] >> (i % 64)) & 1); }
+    void setBit(size_t i) { limbs[i / 64] |= (limb_t) 1 << (i % 64); } // i < Bits
+    size_t bitLength() const; // 0 for zero
+    size_t countTrailingZeros() const; // 0 for zero
+
+    static int compare(const FixedBigInt& a, const FixedBigInt& b);
+    bool operator == (const FixedBigInt& b) const { return limbs == b.limbs; }
+    bool operator != (const FixedBigInt& b) const { return limbs != b.limbs; }
+    bool operator < (const FixedBigInt& b) const { return compare(*this, b) < 0; }
+    bool operator > (const FixedBigInt& b) const { return compare(*this, b) > 0; }
+    bool operator <= (const FixedBigInt& b) const { return compare(*this, b) <= 0; }
+    bool operator >= (const FixedBigInt& b) const { return compare(*this, b) >= 0; }
+
+    // the carry or borrow out of the top limb, for callers that need it
+    limb_t addInPlace(const FixedBigInt& b);
+    limb_t subtractInPlace(const FixedBigInt& b);
+
+    FixedBigInt operator + (const FixedBigInt& b) const { FixedBigInt r = *this; r.addInPlace(b); return r; }
+    FixedBigInt operator - (const FixedBigInt& b) const { FixedBigInt r = *this; r.subtractInPlace(b); return r; }
+    FixedBigInt operator * (const FixedBigInt& b) const; // the low Bits of the product
+    FixedBigInt& operator += (const FixedBigInt& b) { addInPlace(b); return *this; }
+    FixedBigInt& operator -= (const FixedBigInt& b) { subtractInPlace(b); return *this; }
+    FixedBigInt& operator *= (const FixedBigInt& b) { return *this = *this * b; }
+    FixedBigInt operator << (size_t bits) const { FixedBigInt r = *this; return r <<= bits; }
+    FixedBigInt operator >> (size_t bits) const { FixedBigInt r = *this; return r >>= bits; }
+    FixedBigInt& operator <<= (size_t bits);
+    FixedBigInt& operator >>= (size_t bits);
+    FixedBigInt operator & (const FixedBigInt& b) const;
+    FixedBigInt operator | (const FixedBigInt& b) const;
+    FixedBigInt operator ^ (const FixedBigInt& b) const;
+
+    friend ostream& operator << (ostream& out, const FixedBigInt& a) { return out << a.toBigInteger(); }
+};
+
+
+//-------------------------------------------------------------
+// MontgomeryContext's interface for FixedBigInt moduli, with R = 2^Bits: an odd modulus
+// of up to Bits bits, and every value below it. Products and squares go through the same
+// basecase kernels and REDC pass as MontgomeryContext, but in accumulators of a fixed
+// 2 * LIMBS limbs on the stack. Where MontgomeryContext would run its ladder in SIMD
+// lanes, power() does too, through VectorMontgomery's span entry points on digit buffers
+// sized from Bits, so power() never allocates on either path; only the constructor does,
+// for the lane constants.
+template <size_t Bits>
+class FixedMontgomeryContext {
+private:
+    typedef FixedBigInt<Bits> Number;
+    static const size_t LIMBS = Number::LIMBS;
+    // digits of the narrowest lane radix, AVX2's 26 bits, in whole vectors of any kernel
+    static const size_t LANE_DIGITS = ((Bits + 2 + 25) / 26 + 7) / 8 * 8;
+    typedef array<limb_t, LANE_DIGITS> Digits;
+
+    Number modulus;
+    limb_t nPrime; // -N^-1 mod 2^64
+    Number r;      // R mod N, the Montgomery form of 1
+    Number r2;     // R^2 mod N, converts into Montgomery form
+    shared_ptr<const VectorMontgomery> lanes; // null when power() stays scalar
+
+    Number doubleMod(const Number& a) const; // 2a mod N for a < N
+    Number reduce(limb_t* t) const; // t*R^-1 mod N for t < N*R in 2 * LIMBS limbs, clobbering t
+
+public:
+    FixedMontgomeryContext(const Number& mod); // mod must be odd
+
+    Number getModulus() const { return modulus; }
+    Number getOne() const { return r; }
+
+    Number toMont(const Number& a) const { return montMul(a, r2); } // a*R mod N, any a
+    Number fromMont(const Number& a) const { return montMul(a, 1); } // a*R^-1 mod N
+    Number montMul(const Number& a, const Number& b) const; // a*b*R^-1 mod N, b below N
+    Number montSqr(const Number& a) const; // a*a*R^-1 mod N for a below N
+    Number power(const Number& a, const Number& e) const; // a^e with a and the result in Montgomery form
+};
+
+
+//-------------------------------------- FixedBigInt --------------------------------------------------------
+template <size_t Bits>
+const size_t FixedBigInt<Bits>::LIMBS;
+
+
+template <size_t Bits>
+FixedBigInt<Bits>::FixedBigInt(const BigInteger& b) : limbs() {
+    const LimbVector& l = b.getLimbs();
+    if (b.getSign() || l.size() > LIMBS)
+        throw domain_error("FixedBigInt: value must be non-negative and fit in Bits bits");
+    copy(l.begin(), l.end(), limbs.begin());
+}
+
+
+template <size_t Bits>
+template <size_t Other>
+FixedBigInt<Bits>::FixedBigInt(const FixedBigInt<Other>& b) : limbs() {
+    for (size_t i = 0; i < min(LIMBS, FixedBigInt<Other>::LIMBS); i++)
+        limbs[i] = b.limb(i);
+}
+
+
+template <size_t Bits>
+BigInteger FixedBigInt<Bits>::toBigInteger() const {
+    BigInteger b;
+    b.setLimbs(LimbVector(limbs.begin(), limbs.end()));
+    return b;
+}
+
+
+template <size_t Bits>
+bool FixedBigInt<Bits>::isZero() const {
+    limb_t any = 0;
+    for (size_t i = 0; i < LIMBS; i++)
+        any |= limbs[i];
+    return any == 0;
+}
+
+
+template <size_t Bits>
+size_t FixedBigInt<Bits>::bitLength() const {
+    for (size_t i = LIMBS; i-- > 0; ) {
+        if (limbs[i] != 0)
+            return i * 64 + 64 - __builtin_clzll(limbs[i]);
+    }
+    return 0;
+}
+
+
+template <size_t Bits>
+size_t FixedBigInt<Bits>::countTrailingZeros() const {
+    for (size_t i = 0; i < LIMBS; i++) {
+        if (limbs[i] != 0)
+            return i * 64 + __builtin_ctzll(limbs[i]);
+    }
+    return 0;
+}
+
+
+template <size_t Bits>
+int FixedBigInt<Bits>::compare(const FixedBigInt& a, const FixedBigInt& b) {
+    for (size_t i = LIMBS; i-- > 0; ) {
+        if (a.limbs[i] != b.limbs[i])
+            return a.limbs[i] < b.limbs[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+
+template <size_t Bits>
+limb_t FixedBigInt<Bits>::addInPlace(const FixedBigInt& b) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < LIMBS; i++) {
+        dlimb_t t = (dlimb_t) limbs[i] + b.limbs[i] + carry;
+        limbs[i] = (limb_t) t;
+        carry = (limb_t) (t >> 64);
+    }
+    return carry;
+}
+
+
+template <size_t Bits>
+limb_t FixedBigInt<Bits>::subtractInPlace(const FixedBigInt& b) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < LIMBS; i++) {
+        dlimb_t t = (dlimb_t) limbs[i] - b.limbs[i] - borrow;
+        limbs[i] = (limb_t) t;
+        borrow = (limb_t) (t >> 64) & 1;
+    }
+    return borrow;
+}
+
+
+// only the rows and columns that land below limb LIMBS are formed
+template <size_t Bits>
+FixedBigInt<Bits> FixedBigInt<Bits>::operator * (const FixedBigInt& b) const {
+    FixedBigInt r;
+    for (size_t i = 0; i < LIMBS; i++) {
+        limb_t carry = 0;
+        for (size_t j = 0; i + j < LIMBS; j++) {
+            dlimb_t t = (dlimb_t) limbs[i] * b.limbs[j] + r.limbs[i + j] + carry;
+            r.limbs[i + j] = (limb_t) t;
+            carry = (limb_t) (t >> 64);
+        }
+    }
+    return r;
+}
+
+
+template <size_t Bits>
+FixedBigInt<Bits>& FixedBigInt<Bits>::operator <<= (size_t bits) {
+    size_t whole = bits / 64;
+    unsigned part = bits % 64;
+    for (size_t i = LIMBS; i-- > 0; ) {
+        limb_t high = i >= whole ? limbs[i - whole] : 0;
+        limb_t low = i >= whole + 1 ? limbs[i - whole - 1] : 0;
+        limbs[i] = part ? (high << part) | (low >> (64 - part)) : high;
+    }
+    return *this;
+}
+
+
+template <size_t Bits>
+FixedBigInt<Bits>& FixedBigInt<Bits>::operator >>= (size_t bits) {
+    size_t whole = bits / 64;
+    unsigned part = bits % 64;
+    for (size_t i = 0; i < LIMBS; i++) {
+        limb_t low = i + whole < LIMBS ? limbs[i + whole] : 0;
+        limb_t high = i + whole + 1 < LIMBS ? limbs[i + whole + 1] : 0;
+        limbs[i] = part ? (low >> part) | (high << (64 - part)) : low;
+    }
+    return *this;
+}
+
+
+template <size_t Bits>
+FixedBigInt<Bits> FixedBigInt<Bits>::operator & (const FixedBigInt& b) const {
+    FixedBigInt r;
+    for (size_t i = 0; i < LIMBS; i++)
+        r.limbs[i] = limbs[i] & b.limbs[i];
+    return r;
+}
+
+
+template <size_t Bits>
+FixedBigInt<Bits> FixedBigInt<Bits>::operator | (const FixedBigInt& b) const {
+    FixedBigInt r;
+    for (size_t i = 0; i < LIMBS; i++)
+        r.limbs[i] = limbs[i] | b.limbs[i];
+    return r;
+}
+
+
+template <size_t Bits>
+FixedBigInt<Bits> FixedBigInt<Bits>::operator ^ (const FixedBigInt& b) const {
+    FixedBigInt r;
+    for (size_t i = 0; i < LIMBS; i++)
+        r.limbs[i] = limbs[i] ^ b.limbs[i];
+    return r;
+}
+
+
+//-------------------------------------- FixedMontgomeryContext ---------------------------------------------
+// R mod N and R^2 mod N by repeated modular doubling, which needs no division
+template <size_t Bits>
+FixedMontgomeryContext<Bits>::FixedMontgomeryContext(const Number& mod) : modulus(mod) {
+    if (mod.isEven())
+        throw domain_error("FixedMontgomeryContext: modulus must be odd");
+    nPrime = 0 - mpn_binvert_limb(mod.limb(0));
+
+    r = mod == 1 ? 0 : 1;
+    for (size_t i = 0; i < Bits; i++)
+        r = doubleMod(r);
+    r2 = r;
+    for (size_t i = 0; i < Bits; i++)
+        r2 = doubleMod(r2);
+
+    LimbVector n = mod.toBigInteger().getLimbs();
+    if (VectorMontgomery::usable(n.size()))
+        lanes = make_shared<VectorMontgomery>(n, VectorMontgomery::activeKernel(), Bits);
+}
+
+
+// 2a can need Bits + 1 bits, so the bit shifted out counts as well
+template <size_t Bits>
+FixedBigInt<Bits> FixedMontgomeryContext<Bits>::doubleMod(const Number& a) const {
+    bool carry = a.testBit(Bits - 1);
+    Number twice = a << 1;
+    if (carry || twice >= modulus)
+        twice -= modulus;
+    return twice;
+}
+
+
+// full product into a stack accumulator, then one REDC pass, as MontgomeryContext does it
+template <size_t Bits>
+FixedBigInt<Bits> FixedMontgomeryContext<Bits>::montMul(const Number& a, const Number& b) const {
+    limb_t t[2 * LIMBS];
+    mpn_mul_basecase(t, a.data(), LIMBS, b.data(), LIMBS);
+    return reduce(t);
+}
+
+
+template <size_t Bits>
+FixedBigInt<Bits> FixedMontgomeryContext<Bits>::montSqr(const Number& a) const {
+    limb_t t[2 * LIMBS];
+    mpn_sqr_basecase(t, a.data(), LIMBS);
+    return reduce(t);
+}
+
+
+template <size_t Bits>
+FixedBigInt<Bits> FixedMontgomeryContext<Bits>::reduce(limb_t* t) const {
+    Number res;
+    mpn_redc_1(res.data(), t, modulus.data(), LIMBS, nPrime);
+    return res;
+}
+
+
+// the odd powers live on the stack on both ladders, so neither allocates
+template <size_t Bits>
+FixedBigInt<Bits> FixedMontgomeryContext<Bits>::power(const Number& a, const Number& e) const {
+    size_t bits = e.bitLength();
+    if (bits == 0)
+        return r;
+    int k = MontgomeryContext::windowSize(bits);
+
+    if (lanes) {
+        const VectorMontgomery& v = *lanes;
+        auto product = [&v](const Digits& x, const Digits& y) {
+            Digits t;
+            v.multiply(t.data(), x.data(), y.data());
+            return t;
+        };
+        auto square = [&product](const Digits& x) { return product(x, x); };
+
+        array<Digits, 32> oddPowers;
+        v.enter(oddPowers[0].data(), a.data(), LIMBS);
+        Digits aSquared = square(oddPowers[0]);
+        for (size_t i = 1; i < ((size_t) 1 << (k - 1)); i++)
+            oddPowers[i] = product(oddPowers[i - 1], aSquared);
+
+        Digits one;
+        v.one(one.data());
+        Number res;
+        v.leave(res.data(), slidingWindow(one, oddPowers, e, k, square, product).data());
+        return res;
+    }
+
+    array<Number, 32> oddPowers;
+    oddPowers[0] = a;
+    Number aSquared = montSqr(a);
+    for (size_t i = 1; i < ((size_t) 1 << (k - 1)); i++)
+        oddPowers[i] = montMul(oddPowers[i - 1], aSquared);
+
+    return slidingWindow(r, oddPowers, e, k,
+                         [this](const Number& x) { return montSqr(x); },
+                         [this](const Number& x, const Number& y) { return montMul(x, y); });
+}
+
+#endif
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include "GCD.h"
+#include "LimbKernels.h"
+#include "LimbPool.h"
+
+// operands up to this many limbs go straight to binary GCD
+static const size_t BINARY_GCD_LIMBS = 2;
+
+
+//-------------------------------------- Limb helpers -----------------------------------------------------------
+static size_t trailingZeros(const LimbVector& a) {
+    size_t i = 0;
+    while (a[i] == 0)
+        i++;
+    return i * 64 + __builtin_ctzll(a[i]);
+}
+
+
+static void shiftRight(LimbVector& a, size_t bits) {
+    size_t limbs = bits / 64;
+    unsigned s = bits % 64;
+    if (limbs >= a.size()) {
+        a.clear();
+        return;
+    }
+    a.erase(a.begin(), a.begin() + limbs);
+    mpn_rshift(a.data(), a.data(), a.size(), s);
+    BigInteger::trim(a);
+}
+
+
+static void shiftLeft(LimbVector& a, size_t bits) {
+    if (a.empty())
+        return;
+    limb_t out = mpn_lshift(a.data(), a.data(), a.size(), bits % 64);
+    if (out != 0)
+        a.push_back(out);
+    a.insert(a.begin(), bits / 64, 0);
+}
+
+
+// out = a * m
+static void multiplyByLimb(LimbVector& out, const LimbVector& a, limb_t m) {
+    out.resize(a.size() + 1);
+    out[a.size()] = mpn_mul_1(out.data(), a.data(), a.size(), m);
+    BigInteger::trim(out);
+}
+
+
+// r += s on sign-magnitude values, returns the sign of the result
+static bool addSigned(LimbVector& r, bool rNeg, const LimbVector& s, bool sNeg) {
+    if (rNeg == sNeg) {
+        BigInteger::addInPlace(r, s);
+        return rNeg && !r.empty();
+    }
+    if (BigInteger::compare(r, s) >= 0) {
+        BigInteger::subtractInPlace(r, s);
+        return rNeg && !r.empty();
+    }
+    LimbVector difference = s;
+    BigInteger::subtractInPlace(difference, r);
+    r.swap(difference);
+    return sNeg;
+}
+
+
+// out = A*x + B*y for signed single-word A and B, returns the sign of out
+static bool combine(LimbVector& out, const LimbVector& x, bool xNeg, int64_t A,
+                    const LimbVector& y, bool yNeg, int64_t B, LimbVector& scratch) {
+    multiplyByLimb(out, x, A < 0 ? (limb_t) -A : (limb_t) A);
+    multiplyByLimb(scratch, y, B < 0 ? (limb_t) -B : (limb_t) B);
+    return addSigned(out, xNeg != (A < 0), scratch, yNeg != (B < 0));
+}
+
+
+// 63 bits of a starting at bit shift
+static limb_t bitsAt(const LimbVector& a, size_t shift) {
+    size_t i = shift / 64;
+    unsigned s = shift % 64;
+    limb_t window = i < a.size() ? a[i] >> s : 0;
+    if (s != 0 && i + 1 < a.size())
+        window |= a[i + 1] << (64 - s);
+    return window & (~(limb_t) 0 >> 1);
+}
+
+
+static limb_t gcdLimb(limb_t a, limb_t b) {
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do {
+        b >>= __builtin_ctzll(b);
+        if (a > b)
+            swap(a, b);
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+
+//-------------------------------------- Lehmer step ------------------------------------------------------------
+// Knuth 4.5.2 Algorithm L: runs Euclid on the leading 63 bits of a >= b for as long
+// as the quotient is provably the same as the full-precision one, collecting the
+// steps in the cosequence matrix [A B; C D]. Returns false if not even one step
+// was safe, in which case the caller does a full division instead.
+static bool lehmerCofactors(const LimbVector& a, const LimbVector& b,
+                            int64_t& A, int64_t& B, int64_t& C, int64_t& D) {
+    size_t shift = a.size() * 64 - __builtin_clzll(a.back()) - 63;
+    __int128 x = bitsAt(a, shift), y = bitsAt(b, shift);
+    __int128 a0 = 1, b0 = 0, c0 = 0, d0 = 1;
+
+    while (y + c0 > 0 && y + d0 > 0) {
+        __int128 q = (x + a0) / (y + c0);
+        if (q != (x + b0) / (y + d0))
+            break;
+
+        __int128 t = a0 - q * c0;
+        a0 = c0;
+        c0 = t;
+        t = b0 - q * d0;
+        b0 = d0;
+        d0 = t;
+        t = x - q * y;
+        x = y;
+        y = t;
+    }
+
+    // the cofactors never exceed the 63-bit leading digit, so they fit in 64 bits
+    A = (int64_t) a0;
+    B = (int64_t) b0;
+    C = (int64_t) c0;
+    D = (int64_t) d0;
+    return B != 0;
+}
+
+
+//-------------------------------------- GCD --------------------------------------------------------------------
+LimbVector binaryGcd(LimbVector a, LimbVector b) {
+    BigInteger::trim(a);
+    BigInteger::trim(b);
+    if (a.empty())
+        return b;
+    if (b.empty())
+        return a;
+
+    size_t za = trailingZeros(a), zb = trailingZeros(b);
+    shiftRight(a, za);
+    shiftRight(b, zb);
+
+    LimbVector q, r;
+    while (true) {
+        int c = BigInteger::compare(a, b);
+        if (c == 0)
+            break;
+        if (c < 0)
+            a.swap(b);
+        if (a.size() == 1) {
+            a[0] = gcdLimb(a[0], b[0]);
+            break;
+        }
+
+        // a is far longer than b: one division does the work of many subtractions
+        if (a.size() > b.size() + 1) {
+            BigInteger::divideMagnitude(a, b, q, r);
+            a.swap(r);
+            if (a.empty()) {
+                a = b;
+                break;
+            }
+        } else {
+            BigInteger::subtractInPlace(a, b);
+        }
+        shiftRight(a, trailingZeros(a));
+    }
+
+    shiftLeft(a, min(za, zb));
+    return a;
+}
+
+
+LimbVector lehmerGcd(LimbVector a, LimbVector b) {
+    BigInteger::trim(a);
+    BigInteger::trim(b);
+
+    if (BigInteger::compare(a, b) < 0)
+        a.swap(b);
+
+    LimbPool::Scope scope; // the fallback divisions allocate their working copies per step
+    LimbVector q, r, t1, t2, scratch;
+    while (b.size() > BINARY_GCD_LIMBS) {
+        int64_t A, B, C, D;
+        if (lehmerCofactors(a, b, A, B, C, D)) {
+            combine(t1, a, false, A, b, false, B, scratch);
+            combine(t2, a, false, C, b, false, D, scratch);
+            a.swap(t1);
+            b.swap(t2);
+        } else {
+            BigInteger::divideMagnitude(a, b, q, r);
+            a.swap(b);
+            b.swap(r);
+        }
+        if (BigInteger::compare(a, b) < 0)
+            a.swap(b);
+    }
+    return binaryGcd(a, b);
+}
+
+
+LimbVector gcdMagnitude(const LimbVector& a, const LimbVector& b) {
+    if (max(a.size(), b.size()) <= BINARY_GCD_LIMBS)
+        return binaryGcd(a, b);
+    return lehmerGcd(a, b);
+}
+
+
+// Lehmer steps and full division steps as in lehmerGcd(), with the coefficient of the
+// original a carried along: a_i = u0 * a + (something) * b, b_i = u1 * a + ... .
+// The coefficient of b is recovered at the end from y = (g - a*x) / b.
+LimbVector gcdExtendedMagnitude(const LimbVector& a0, const LimbVector& b0,
+                                LimbVector& x, bool& xNeg, LimbVector& y, bool& yNeg) {
+    LimbVector a = a0, b = b0;
+    BigInteger::trim(a);
+    BigInteger::trim(b);
+
+    LimbPool::Scope scope;
+    LimbVector u0(1, 1), u1;
+    bool u0Neg = false, u1Neg = false;
+    LimbVector q, r, t1, t2, scratch;
+
+    while (!b.empty()) {
+        int64_t A, B, C, D;
+        if (b.size() > 1 && BigInteger::compare(a, b) >= 0 && lehmerCofactors(a, b, A, B, C, D)) {
+            combine(t1, a, false, A, b, false, B, scratch);
+            combine(t2, a, false, C, b, false, D, scratch);
+            a.swap(t1);
+            b.swap(t2);
+
+            bool n0 = combine(t1, u0, u0Neg, A, u1, u1Neg, B, scratch);
+            bool n1 = combine(t2, u0, u0Neg, C, u1, u1Neg, D, scratch);
+            u0.swap(t1);
+            u1.swap(t2);
+            u0Neg = n0;
+            u1Neg = n1;
+        } else {
+            BigInteger::divideMagnitude(a, b, q, r);
+            a.swap(b);
+            b.swap(r);
+
+            // (u0, u1) = (u1, u0 - q * u1)
+            LimbVector product = BigInteger::multiply(q, u1);
+            bool n1 = addSigned(u0, u0Neg, product, !u1Neg);
+            u0.swap(u1);
+            u0Neg = u1Neg;
+            u1Neg = n1;
+        }
+    }
+
+    x = u0;
+    xNeg = u0Neg && !x.empty();
+
+    y.clear();
+    yNeg = false;
+    if (!b0.empty()) {
+        LimbVector numerator = a;
+        LimbVector product = BigInteger::multiply(a0, x);
+        bool negative = addSigned(numerator, false, product, !xNeg);
+        BigInteger::divideMagnitude(numerator, b0, y, r);
+        yNeg = negative && !y.empty();
+    }
+    return a;
+}
@@ -0,0 +1,20 @@
+#ifndef GCD_H
+#define GCD_H
+
+#include <vector>
+#include "BigInteger.h"
+
+// GCD engine working directly on limb magnitudes (least significant limb first).
+// Operands of at most two limbs use binary GCD; larger ones use Lehmer's
+// algorithm, which replaces runs of single-precision Euclid steps on the leading
+// 63 bits with one multi-precision linear combination.
+LimbVector binaryGcd(LimbVector a, LimbVector b);
+LimbVector lehmerGcd(LimbVector a, LimbVector b);
+LimbVector gcdMagnitude(const LimbVector& a, const LimbVector& b);
+
+// Extended Lehmer GCD on magnitudes: returns g = gcd(a, b) and sets x, y with
+// a*x + b*y = g. The coefficients are signed, with the signs in xNeg and yNeg.
+LimbVector gcdExtendedMagnitude(const LimbVector& a, const LimbVector& b,
+                                LimbVector& x, bool& xNeg, LimbVector& y, bool& yNeg);
+
+#endif
@@ -0,0 +1,268 @@
+#include <cstring>
+#include "LimbKernels.h"
+
+
+//-------------------------------------- Addition and subtraction ---------------------------------------------
+int mpn_cmp(const limb_t* a, const limb_t* b, size_t n) {
+    for (size_t i = n; i-- > 0; ) {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+
+limb_t mpn_add_n(limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb_t t = (dlimb_t) a[i] + b[i] + carry;
+        r[i] = (limb_t) t;
+        carry = (limb_t) (t >> 64);
+    }
+    return carry;
+}
+
+
+limb_t mpn_sub_n(limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        // a wrapped difference leaves all ones in the high half
+        dlimb_t t = (dlimb_t) a[i] - b[i] - borrow;
+        r[i] = (limb_t) t;
+        borrow = (limb_t) (t >> 64) & 1;
+    }
+    return borrow;
+}
+
+
+// once the carry dies out the rest of a is copied, or left alone when r is a
+limb_t mpn_add_1(limb_t* r, const limb_t* a, size_t n, limb_t b) {
+    size_t i = 0;
+    for (; i < n && b != 0; i++) {
+        r[i] = a[i] + b;
+        b = r[i] < b;
+    }
+    if (r != a && i < n)
+        memcpy(r + i, a + i, (n - i) * sizeof(limb_t));
+    return b;
+}
+
+
+limb_t mpn_sub_1(limb_t* r, const limb_t* a, size_t n, limb_t b) {
+    size_t i = 0;
+    for (; i < n && b != 0; i++) {
+        limb_t x = a[i];
+        r[i] = x - b;
+        b = x < b;
+    }
+    if (r != a && i < n)
+        memcpy(r + i, a + i, (n - i) * sizeof(limb_t));
+    return b;
+}
+
+
+limb_t mpn_add(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn) {
+    limb_t carry = mpn_add_n(r, a, b, bn);
+    return mpn_add_1(r + bn, a + bn, an - bn, carry);
+}
+
+
+limb_t mpn_sub(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn) {
+    limb_t borrow = mpn_sub_n(r, a, b, bn);
+    return mpn_sub_1(r + bn, a + bn, an - bn, borrow);
+}
+
+
+//-------------------------------------- Multiplication -------------------------------------------------------
+limb_t mpn_mul_1(limb_t* r, const limb_t* a, size_t n, limb_t b) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb_t t = (dlimb_t) a[i] * b + carry;
+        r[i] = (limb_t) t;
+        carry = (limb_t) (t >> 64);
+    }
+    return carry;
+}
+
+
+limb_t mpn_addmul_1(limb_t* r, const limb_t* a, size_t n, limb_t b) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb_t t = (dlimb_t) a[i] * b + r[i] + carry;
+        r[i] = (limb_t) t;
+        carry = (limb_t) (t >> 64);
+    }
+    return carry;
+}
+
+
+limb_t mpn_submul_1(limb_t* r, const limb_t* a, size_t n, limb_t b) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb_t p = (dlimb_t) a[i] * b + borrow;
+        limb_t low = (limb_t) p;
+        borrow = (limb_t) (p >> 64) + (r[i] < low);
+        r[i] -= low;
+    }
+    return borrow;
+}
+
+
+// one row per limb of b, each a single pass of addmul_1 over a
+void mpn_mul_basecase(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn) {
+    r[an] = mpn_mul_1(r, a, an, b[0]);
+    for (size_t j = 1; j < bn; j++)
+        r[an + j] = mpn_addmul_1(r + j, a, an, b[j]);
+}
+
+
+// Every cross product a[i]*a[j] with i < j is formed once, the triangle is doubled
+// with a one-bit shift and the squares a[i]^2 are added down the diagonal. That is
+// n(n-1)/2 + n limb products against n^2 for mul_basecase.
+void mpn_sqr_basecase(limb_t* r, const limb_t* a, size_t n) {
+    if (n == 1) {
+        dlimb_t p = (dlimb_t) a[0] * a[0];
+        r[0] = (limb_t) p;
+        r[1] = (limb_t) (p >> 64);
+        return;
+    }
+
+    r[0] = 0;
+    r[n] = mpn_mul_1(r + 1, a + 1, n - 1, a[0]);
+    for (size_t i = 1; i + 1 < n; i++)
+        r[n + i] = mpn_addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    r[2 * n - 1] = 0;
+
+    mpn_lshift(r, r, 2 * n, 1);
+
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        dlimb_t p = (dlimb_t) a[i] * a[i];
+        dlimb_t t = (dlimb_t) r[2 * i] + (limb_t) p + carry;
+        r[2 * i] = (limb_t) t;
+        t = (dlimb_t) r[2 * i + 1] + (limb_t) (p >> 64) + (limb_t) (t >> 64);
+        r[2 * i + 1] = (limb_t) t;
+        carry = (limb_t) (t >> 64);
+    }
+}
+
+
+// a*a = 1 mod 8 for odd a, so a itself is right in its low 3 bits, and each Newton
+// step doubles that: 6, 12, 24, 48, 96
+limb_t mpn_binvert_limb(limb_t a) {
+    limb_t inv = a;
+    for (int i = 0; i < 5; i++)
+        inv *= 2 - a * inv;
+    return inv;
+}
+
+
+// Row i adds m*N so that limb i becomes zero. Its carry belongs at limb i + n, above every
+// limb a later row reads, so it is parked in the freed limb i and all carries are added in
+// one pass at the end, as in GMP's redc_1. The sum is below 2N, so one conditional
+// subtraction brings it below N.
+void mpn_redc_1(limb_t* r, limb_t* t, const limb_t* m, size_t n, limb_t nPrime) {
+    for (size_t i = 0; i < n; i++) {
+        limb_t q = t[i] * nPrime;
+        t[i] = mpn_addmul_1(t + i, m, n, q);
+    }
+    limb_t top = mpn_add_n(r, t + n, t, n);
+    if (top != 0 || mpn_cmp(r, m, n) >= 0)
+        mpn_sub_n(r, r, m, n);
+}
+
+
+//-------------------------------------- Division by one limb -------------------------------------------------
+limb_t mpn_invert_limb(limb_t d) {
+    // the quotient lies in [2^64, 2^65), so dropping its top bit subtracts 2^64
+    return (limb_t) (~(dlimb_t) 0 / d);
+}
+
+
+// Moller and Granlund, "Improved division by invariant integers" (2011), Algorithm 4:
+// divides <u1, u0> by the normalised d with u1 < d, returning the quotient and
+// leaving the remainder in r
+static inline limb_t divideByReciprocal(limb_t u1, limb_t u0, limb_t d, limb_t v, limb_t& r) {
+    dlimb_t q = (dlimb_t) v * u1 + (((dlimb_t) u1 << 64) | u0);
+    limb_t q1 = (limb_t) (q >> 64) + 1;
+    limb_t q0 = (limb_t) q;
+    r = u0 - q1 * d;
+    if (r > q0) {
+        q1--;
+        r += d;
+    }
+    if (r >= d) {
+        q1++;
+        r -= d;
+    }
+    return q1;
+}
+
+
+// d is shifted up until its top bit is set and the dividend is shifted along with it
+// one limb at a time, which leaves the quotient alone and scales the remainder
+limb_t mpn_divrem_1(limb_t* q, const limb_t* a, size_t n, limb_t d) {
+    if (n == 0)
+        return 0;
+    int shift = __builtin_clzll(d);
+    d <<= shift;
+    limb_t v = mpn_invert_limb(d);
+
+    limb_t r = shift ? a[n - 1] >> (64 - shift) : 0;
+    for (size_t i = n; i-- > 0; ) {
+        limb_t u0 = a[i] << shift;
+        if (shift && i > 0)
+            u0 |= a[i - 1] >> (64 - shift);
+        q[i] = divideByReciprocal(r, u0, d, v, r);
+    }
+    return r >> shift;
+}
+
+
+limb_t mpn_mod_1(const limb_t* a, size_t n, limb_t d) {
+    if (n == 0)
+        return 0;
+    int shift = __builtin_clzll(d);
+    d <<= shift;
+    limb_t v = mpn_invert_limb(d);
+
+    limb_t r = shift ? a[n - 1] >> (64 - shift) : 0;
+    for (size_t i = n; i-- > 0; ) {
+        limb_t u0 = a[i] << shift;
+        if (shift && i > 0)
+            u0 |= a[i - 1] >> (64 - shift);
+        divideByReciprocal(r, u0, d, v, r);
+    }
+    return r >> shift;
+}
+
+
+//-------------------------------------- Shifts ---------------------------------------------------------------
+limb_t mpn_lshift(limb_t* r, const limb_t* a, size_t n, unsigned cnt) {
+    if (n == 0)
+        return 0;
+    if (cnt == 0) {
+        memmove(r, a, n * sizeof(limb_t));
+        return 0;
+    }
+    limb_t out = a[n - 1] >> (64 - cnt);
+    for (size_t i = n - 1; i > 0; i--)
+        r[i] = (a[i] << cnt) | (a[i - 1] >> (64 - cnt));
+    r[0] = a[0] << cnt;
+    return out;
+}
+
+
+limb_t mpn_rshift(limb_t* r, const limb_t* a, size_t n, unsigned cnt) {
+    if (n == 0)
+        return 0;
+    if (cnt == 0) {
+        memmove(r, a, n * sizeof(limb_t));
+        return 0;
+    }
+    limb_t out = a[0] << (64 - cnt);
+    for (size_t i = 0; i + 1 < n; i++)
+        r[i] = (a[i] >> cnt) | (a[i + 1] << (64 - cnt));
+    r[n - 1] = a[n - 1] >> cnt;
+    return out;
+}
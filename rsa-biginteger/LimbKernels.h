@@ -0,0 +1,61 @@
+#ifndef LIMBKERNELS_H
+#define LIMBKERNELS_H
+
+#include <cstddef>
+#include "LimbVector.h"
+
+//-------------------------------------------------------------
+// Low-level kernels on raw limb spans, least significant limb first, in the style
+// of GMP's mpn layer. None of them allocates: every result goes into storage the
+// caller provides. Unless noted, r may be the same span as a (or b), but must not
+// overlap it partially.
+
+// -1, 0 or 1 as a is below, equal to or above b, both n limbs long
+int mpn_cmp(const limb_t* a, const limb_t* b, size_t n);
+
+// r = a + b over n limbs, returns the carry out
+limb_t mpn_add_n(limb_t* r, const limb_t* a, const limb_t* b, size_t n);
+// r = a - b over n limbs, returns the borrow out
+limb_t mpn_sub_n(limb_t* r, const limb_t* a, const limb_t* b, size_t n);
+
+// r = a + b and r = a - b for an >= bn; r has an limbs
+limb_t mpn_add(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+limb_t mpn_sub(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+
+// r = a + b and r = a - b for a single limb b
+limb_t mpn_add_1(limb_t* r, const limb_t* a, size_t n, limb_t b);
+limb_t mpn_sub_1(limb_t* r, const limb_t* a, size_t n, limb_t b);
+
+// r = a * b, returns the high limb
+limb_t mpn_mul_1(limb_t* r, const limb_t* a, size_t n, limb_t b);
+// r += a * b, returns the limb carried out of r[n - 1]
+limb_t mpn_addmul_1(limb_t* r, const limb_t* a, size_t n, limb_t b);
+// r -= a * b, returns the limb borrowed out of r[n - 1]
+limb_t mpn_submul_1(limb_t* r, const limb_t* a, size_t n, limb_t b);
+
+// r = a * b into an + bn limbs for an >= bn >= 1; r must not overlap a or b
+void mpn_mul_basecase(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+// r = a * a into 2n limbs for n >= 1; r must not overlap a
+void mpn_sqr_basecase(limb_t* r, const limb_t* a, size_t n);
+
+// a^-1 mod 2^64 for odd a, as GMP's binvert_limb; Montgomery factors are its negation
+limb_t mpn_binvert_limb(limb_t a);
+// Montgomery reduction: r = t * 2^(-64n) mod m for odd m of n limbs, t < m * 2^(64n)
+// in 2n limbs and nPrime = -m^-1 mod 2^64. t is clobbered; r may be its low n limbs
+void mpn_redc_1(limb_t* r, limb_t* t, const limb_t* m, size_t n, limb_t nPrime);
+
+// floor((2^128 - 1) / d) - 2^64 for d with its top bit set: the Moller-Granlund
+// reciprocal that turns each two-by-one limb division into two multiplications
+limb_t mpn_invert_limb(limb_t d);
+// q = a / d over n limbs for d != 0, returns a mod d; q may be a
+limb_t mpn_divrem_1(limb_t* q, const limb_t* a, size_t n, limb_t d);
+// a mod d for d != 0 without writing a quotient
+limb_t mpn_mod_1(const limb_t* a, size_t n, limb_t d);
+
+// r = a << cnt and r = a >> cnt for 0 <= cnt < 64, returning the bits shifted out
+// (at the bottom of the limb for lshift, at the top for rshift). lshift runs from
+// the top down, so r may sit above a; rshift runs upward, so r may sit below a.
+limb_t mpn_lshift(limb_t* r, const limb_t* a, size_t n, unsigned cnt);
+limb_t mpn_rshift(limb_t* r, const limb_t* a, size_t n, unsigned cnt);
+
+#endif
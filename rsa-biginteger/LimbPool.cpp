@@ -0,0 +1,105 @@
+#include <vector>
+#include "LimbPool.h"
+
+using namespace std;
+
+// block sizes run from 2^MIN_CLASS to 2^MAX_CLASS limbs, larger ones are not cached
+static const int MIN_CLASS = 5;
+static const int MAX_CLASS = 24;
+
+// Set once the calling thread's cache is gone. Values in static storage, such as the
+// primorial cache in Primality.cpp, are destroyed after the main thread's thread-locals,
+// so their buffers still reach release() then; the flag itself is trivially destructible
+// and stays readable until the thread is gone.
+static thread_local bool cacheDestroyed = false;
+
+struct ThreadCache {
+    int depth;
+    vector<limb_t*> free[MAX_CLASS + 1];
+    unsigned long long served, bytes, system;
+
+    ThreadCache() : depth(0), served(0), bytes(0), system(0) {}
+    ~ThreadCache() {
+        trim();
+        cacheDestroyed = true;
+    }
+
+    void trim() {
+        for (int c = MIN_CLASS; c <= MAX_CLASS; c++) {
+            for (size_t i = 0; i < free[c].size(); i++)
+                delete[] free[c][i];
+            free[c].clear();
+        }
+    }
+};
+
+static thread_local ThreadCache cache;
+
+
+static int sizeClass(size_t limbs) {
+    int c = MIN_CLASS;
+    while (c <= MAX_CLASS && ((size_t) 1 << c) < limbs)
+        c++;
+    return c;
+}
+
+
+//-------------------------------------- Scope ---------------------------------------------------------------
+LimbPool::Scope::Scope() {
+    if (!cacheDestroyed)
+        cache.depth++;
+}
+
+
+LimbPool::Scope::~Scope() {
+    if (!cacheDestroyed && --cache.depth == 0)
+        cache.trim();
+}
+
+
+//-------------------------------------- Blocks --------------------------------------------------------------
+limb_t* LimbPool::allocate(size_t& limbs) {
+    int c = sizeClass(limbs);
+    if (c > MAX_CLASS)
+        return new limb_t[limbs];
+
+    limbs = (size_t) 1 << c;
+    if (cacheDestroyed || cache.depth == 0)
+        return new limb_t[limbs];
+
+    cache.served++;
+    cache.bytes += limbs * sizeof(limb_t);
+    if (!cache.free[c].empty()) {
+        limb_t* block = cache.free[c].back();
+        cache.free[c].pop_back();
+        return block;
+    }
+    cache.system++;
+    return new limb_t[limbs];
+}
+
+
+void LimbPool::release(limb_t* block, size_t limbs) {
+    int c = sizeClass(limbs);
+    if (cacheDestroyed || cache.depth == 0 || c > MAX_CLASS) {
+        delete[] block;
+        return;
+    }
+    cache.free[c].push_back(block);
+}
+
+
+//-------------------------------------- Statistics ----------------------------------------------------------
+unsigned long long LimbPool::allocationsServed() {
+    return cache.served;
+}
+
+
+unsigned long long LimbPool::bytesServed() {
+    return cache.bytes;
+}
+
+
+unsigned long long LimbPool::systemAllocations() {
+    return cache.system;
+}
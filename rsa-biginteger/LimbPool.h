@@ -0,0 +1,38 @@
+#ifndef LIMBPOOL_H
+#define LIMBPOOL_H
+
+#include <cstddef>
+#include "LimbVector.h"
+
+//-------------------------------------------------------------
+// Per-thread pool for LimbVector's heap buffers. Blocks come in power-of-two sizes
+// and are always plain heap allocations, so a value may outlive the scope it was
+// made in or be freed on another thread. While a Scope is open on a thread, freed
+// blocks are kept on that thread's free lists and handed back out to the next
+// request of the same size instead of going through malloc, which is what an
+// exponentiation or a long division does thousands of times with a handful of sizes.
+// When the outermost Scope closes, every cached block is released in one step.
+class LimbPool {
+public:
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+
+    private:
+        Scope(const Scope&);
+        Scope& operator = (const Scope&);
+    };
+
+    // a block of at least limbs limbs; limbs is rounded up to the block's real size
+    static limb_t* allocate(size_t& limbs);
+    static void release(limb_t* block, size_t limbs);
+
+    // counters of the calling thread: requests made inside a Scope, their size in
+    // bytes, and how many of them had to go to the system allocator
+    static unsigned long long allocationsServed();
+    static unsigned long long bytesServed();
+    static unsigned long long systemAllocations();
+};
+
+#endif
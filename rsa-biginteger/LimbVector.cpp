@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include "LimbPool.h"
+#include "LimbVector.h"
+
+using namespace std;
+
+// Only touched when a buffer is acquired, never per limb. Every thread counts into its
+// own pair, as LimbPool keeps its statistics, so growing a vector never writes a cache
+// line shared with other threads; only the owner writes a pair, and readers sum all of
+// them. A thread's counts move into the retired totals when it exits.
+struct ThreadCounters {
+    atomic<unsigned long long> inlineCount, heapCount;
+    ThreadCounters* prev;
+    ThreadCounters* next;
+
+    ThreadCounters();
+    ~ThreadCounters();
+};
+
+static mutex countersLock;
+static ThreadCounters* liveCounters = NULL;
+static unsigned long long retiredInline = 0, retiredHeap = 0;
+
+ThreadCounters::ThreadCounters() : inlineCount(0), heapCount(0), prev(NULL) {
+    lock_guard<mutex> guard(countersLock);
+    next = liveCounters;
+    if (next != NULL)
+        next->prev = this;
+    liveCounters = this;
+}
+
+ThreadCounters::~ThreadCounters() {
+    lock_guard<mutex> guard(countersLock);
+    retiredInline += inlineCount.load(memory_order_relaxed);
+    retiredHeap += heapCount.load(memory_order_relaxed);
+    if (prev != NULL)
+        prev->next = next;
+    else
+        liveCounters = next;
+    if (next != NULL)
+        next->prev = prev;
+}
+
+static thread_local ThreadCounters counters;
+
+// no other thread writes the counter, so a plain load and store cannot lose a count
+static void bump(atomic<unsigned long long>& counter) {
+    counter.store(counter.load(memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+
+//-------------------------------------- Storage -------------------------------------------------------------
+// First use of the inline buffer costs nothing but the bookkeeping; past INLINE_LIMBS
+// the capacity at least doubles, rounded up to a LimbPool block, so push_back stays
+// amortised O(1).
+void LimbVector::grow(size_t n) {
+    if (ptr == local && n <= INLINE_LIMBS) {
+        cap = INLINE_LIMBS;
+        bump(counters.inlineCount);
+        return;
+    }
+
+    size_t newCap = max(n, 2 * cap);
+    limb_t* buffer = LimbPool::allocate(newCap);
+    bump(counters.heapCount);
+    memcpy(buffer, ptr, count * sizeof(limb_t));
+    if (ptr != local)
+        release(ptr, cap);
+    ptr = buffer;
+    cap = newCap;
+}
+
+
+// steals a heap buffer, or copies the few limbs of an inline one
+void LimbVector::take(LimbVector& other) {
+    if (other.ptr != other.local) {
+        ptr = other.ptr;
+        cap = other.cap;
+    } else {
+        memcpy(local, other.local, other.count * sizeof(limb_t));
+        cap = other.cap;
+    }
+    count = other.count;
+    other.ptr = other.local;
+    other.count = 0;
+    other.cap = 0;
+}
+
+
+void LimbVector::release(limb_t* buffer, size_t limbs) {
+    LimbPool::release(buffer, limbs);
+}
+
+
+//-------------------------------------- Editing -------------------------------------------------------------
+void LimbVector::insert(iterator pos, size_t n, limb_t value) {
+    size_t at = pos - ptr;
+    reserve(count + n);
+    memmove(ptr + at + n, ptr + at, (count - at) * sizeof(limb_t));
+    for (size_t i = 0; i < n; i++)
+        ptr[at + i] = value;
+    count += n;
+}
+
+
+LimbVector::iterator LimbVector::erase(iterator first, iterator last) {
+    memmove(first, last, (end() - last) * sizeof(limb_t));
+    count -= last - first;
+    return first;
+}
+
+
+void LimbVector::swap(LimbVector& other) {
+    if (ptr != local && other.ptr != other.local) {
+        std::swap(ptr, other.ptr);
+        std::swap(count, other.count);
+        std::swap(cap, other.cap);
+        return;
+    }
+    LimbVector temp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temp);
+}
+
+
+//-------------------------------------- Statistics ----------------------------------------------------------
+unsigned long long LimbVector::inlineAllocations() {
+    lock_guard<mutex> guard(countersLock);
+    unsigned long long total = retiredInline;
+    for (ThreadCounters* c = liveCounters; c != NULL; c = c->next)
+        total += c->inlineCount.load(memory_order_relaxed);
+    return total;
+}
+
+
+unsigned long long LimbVector::heapAllocations() {
+    lock_guard<mutex> guard(countersLock);
+    unsigned long long total = retiredHeap;
+    for (ThreadCounters* c = liveCounters; c != NULL; c = c->next)
+        total += c->heapCount.load(memory_order_relaxed);
+    return total;
+}
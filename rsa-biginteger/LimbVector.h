@@ -0,0 +1,132 @@
+#ifndef LIMBVECTOR_H
+#define LIMBVECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+typedef uint64_t limb_t;            // one base 2^64 digit
+typedef unsigned __int128 dlimb_t;  // holds the full product of two limbs
+
+//-------------------------------------------------------------
+// Limb storage with the parts of the std::vector interface the arithmetic uses.
+// Up to INLINE_LIMBS limbs live inside the object itself, so counters, rand()
+// results, the constants 0, 1 and 2 and every residue modulo a 1024-bit number
+// never touch the heap. Longer magnitudes move to a heap buffer that grows
+// geometrically like a vector's.
+class LimbVector {
+public:
+    static const size_t INLINE_LIMBS = 16; // a 1024-bit modulus
+
+    typedef limb_t value_type;
+    typedef limb_t* iterator;
+    typedef const limb_t* const_iterator;
+
+    LimbVector() : ptr(local), count(0), cap(0) {}
+    explicit LimbVector(size_t n, limb_t value = 0) : ptr(local), count(0), cap(0) {
+        assign(n, value);
+    }
+    LimbVector(const limb_t* first, const limb_t* last) : ptr(local), count(0), cap(0) {
+        assign(first, last);
+    }
+    LimbVector(const LimbVector& other) : ptr(local), count(0), cap(0) {
+        assign(other.begin(), other.end());
+    }
+    LimbVector(LimbVector&& other) noexcept : ptr(local), count(0), cap(0) {
+        take(other);
+    }
+    ~LimbVector() {
+        if (ptr != local)
+            release(ptr, cap);
+    }
+
+    LimbVector& operator = (const LimbVector& other) {
+        if (this != &other)
+            assign(other.begin(), other.end());
+        return *this;
+    }
+    LimbVector& operator = (LimbVector&& other) noexcept {
+        if (this != &other) {
+            if (ptr != local)
+                release(ptr, cap);
+            ptr = local;
+            count = 0;
+            cap = 0;
+            take(other);
+        }
+        return *this;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return cap; }
+
+    limb_t* data() { return ptr; }
+    const limb_t* data() const { return ptr; }
+    iterator begin() { return ptr; }
+    iterator end() { return ptr + count; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr + count; }
+
+    limb_t& operator [] (size_t i) { return ptr[i]; }
+    const limb_t& operator [] (size_t i) const { return ptr[i]; }
+    limb_t& back() { return ptr[count - 1]; }
+    const limb_t& back() const { return ptr[count - 1]; }
+
+    void reserve(size_t n) {
+        if (n > cap)
+            grow(n);
+    }
+
+    void clear() { count = 0; }
+    void pop_back() { count--; }
+
+    void push_back(limb_t value) {
+        if (count == cap)
+            grow(count + 1);
+        ptr[count++] = value;
+    }
+
+    void resize(size_t n, limb_t value = 0) {
+        if (n > count) {
+            reserve(n);
+            for (size_t i = count; i < n; i++)
+                ptr[i] = value;
+        }
+        count = n;
+    }
+
+    void assign(size_t n, limb_t value) {
+        count = 0;
+        resize(n, value);
+    }
+
+    void assign(const limb_t* first, const limb_t* last) {
+        size_t n = last - first;
+        reserve(n);
+        memmove(ptr, first, n * sizeof(limb_t));
+        count = n;
+    }
+
+    void insert(iterator pos, size_t n, limb_t value);
+    iterator erase(iterator first, iterator last);
+    void swap(LimbVector& other);
+
+    // number of buffers served from inline storage and from the heap since the
+    // program started, summed over all threads; a plain vector would have allocated
+    // for every one of them
+    static unsigned long long inlineAllocations();
+    static unsigned long long heapAllocations();
+
+private:
+    limb_t* ptr;
+    size_t count;
+    size_t cap; // 0 until the first limb is stored, even while ptr is local
+    limb_t local[INLINE_LIMBS];
+
+    void grow(size_t n);
+    void take(LimbVector& other);
+    static void release(limb_t* buffer, size_t limbs);
+};
+
+#endif
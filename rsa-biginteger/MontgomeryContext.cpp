@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <stdexcept>
+#include "LimbKernels.h"
+#include "LimbPool.h"
+#include "MontgomeryContext.h"
+#include "SlidingWindow.h"
+
+
+//-------------------------------------- Constructor -----------------------------------------------------------
+MontgomeryContext::MontgomeryContext(const BigInteger& mod) {
+    if (mod.getSign() || mod.isEven())
+        throw domain_error("MontgomeryContext: modulus must be odd and positive");
+
+    modulus = mod;
+    n = mod.getLimbs();
+    nPrime = 0 - mpn_binvert_limb(n[0]);
+
+    LimbVector power(n.size() + 1, 0);
+    power[n.size()] = 1;
+    r.setLimbs(power);
+    r = r % modulus;
+
+    power.assign(2 * n.size() + 1, 0);
+    power[2 * n.size()] = 1;
+    r2.setLimbs(power);
+    r2 = r2 % modulus;
+
+    if (VectorMontgomery::usable(n.size()))
+        lanes = make_shared<VectorMontgomery>(n, VectorMontgomery::activeKernel(), 64 * n.size());
+}
+
+
+BigInteger MontgomeryContext::getModulus() const {
+    return modulus;
+}
+
+
+BigInteger MontgomeryContext::getOne() const {
+    return r;
+}
+
+
+//-------------------------------------- Conversion -----------------------------------------------------------
+BigInteger MontgomeryContext::toMont(const BigInteger& a) const {
+    BigInteger reduced = a % modulus;
+    if (reduced.getSign())
+        reduced += modulus;
+    return montMul(reduced, r2);
+}
+
+
+BigInteger MontgomeryContext::fromMont(const BigInteger& a) const {
+    return montMul(a, 1);
+}
+
+
+//-------------------------------------- Arithmetic -----------------------------------------------------------
+BigInteger MontgomeryContext::montMul(const BigInteger& a, const BigInteger& b) const {
+    BigInteger res;
+    res.setLimbs(multiply(a.getLimbs(), b.getLimbs()));
+    return res;
+}
+
+
+BigInteger MontgomeryContext::montSqr(const BigInteger& a) const {
+    BigInteger res;
+    res.setLimbs(square(a.getLimbs()));
+    return res;
+}
+
+
+// the same breakpoints OpenSSL uses
+int MontgomeryContext::windowSize(size_t bits) {
+    if (bits > 671)
+        return 6;
+    if (bits > 239)
+        return 5;
+    if (bits > 79)
+        return 4;
+    if (bits > 23)
+        return 3;
+    return 1;
+}
+
+
+BigInteger MontgomeryContext::power(const BigInteger& a, const BigInteger& e) const {
+    if (e <= 0)
+        return r;
+
+    LimbPool::Scope scope; // every temporary of the ladder reuses a few pooled buffers
+    if (lanes)
+        return lanes->power(a, e);
+    int k = windowSize(e.bitLength());
+
+    vector<BigInteger> oddPowers(1 << (k - 1));
+    oddPowers[0] = a;
+    BigInteger aSquared = montSqr(a);
+    for (size_t i = 1; i < oddPowers.size(); i++)
+        oddPowers[i] = montMul(oddPowers[i - 1], aSquared);
+
+    return slidingWindow(r, oddPowers, e, k,
+                         [this](const BigInteger& x) { return montSqr(x); },
+                         [this](const BigInteger& x, const BigInteger& y) { return montMul(x, y); });
+}
+
+
+// full product first, then one REDC pass; a and b are below N, so t = a*b < N*R
+LimbVector MontgomeryContext::multiply(const LimbVector& a, const LimbVector& b) const {
+    if (a.empty() || b.empty())
+        return LimbVector();
+    const LimbVector& longer = a.size() >= b.size() ? a : b;
+    const LimbVector& shorter = a.size() >= b.size() ? b : a;
+
+    LimbVector t(2 * n.size());
+    mpn_mul_basecase(t.data(), longer.data(), longer.size(), shorter.data(), shorter.size());
+    reduce(t);
+    return t;
+}
+
+
+LimbVector MontgomeryContext::square(const LimbVector& a) const {
+    if (a.empty())
+        return LimbVector();
+
+    LimbVector t(2 * n.size());
+    mpn_sqr_basecase(t.data(), a.data(), a.size());
+    reduce(t);
+    return t;
+}
+
+
+// REDC of t < N*R held in 2s limbs, leaving t*R^-1 mod N in its low s limbs
+void MontgomeryContext::reduce(LimbVector& t) const {
+    mpn_redc_1(t.data(), t.data(), n.data(), n.size(), nPrime);
+    t.resize(n.size());
+}
@@ -0,0 +1,45 @@
+#ifndef MONTGOMERYCONTEXT_H
+#define MONTGOMERYCONTEXT_H
+
+#include <memory>
+#include <vector>
+#include "BigInteger.h"
+#include "VectorMontgomery.h"
+
+//-------------------------------------------------------------
+// Montgomery arithmetic modulo an odd N with R = 2^(64 * limbs of N).
+// A value a is kept as a*R mod N, so a product only needs a word-by-word
+// reduction instead of a long division. Build one per modulus and reuse it.
+// From VectorMontgomery::threshold() limbs up, on CPUs with AVX2 or AVX-512 IFMA,
+// power() runs its ladder in VectorMontgomery's SIMD lanes instead.
+class MontgomeryContext {
+private:
+    BigInteger modulus;
+    LimbVector n; // limbs of the modulus
+    limb_t nPrime;    // -N^-1 mod 2^64
+    BigInteger r;     // R mod N, the Montgomery form of 1
+    BigInteger r2;    // R^2 mod N, converts into Montgomery form
+
+    shared_ptr<const VectorMontgomery> lanes; // null when power() stays scalar
+
+public:
+    MontgomeryContext(const BigInteger& mod); // mod must be odd
+
+    BigInteger getModulus() const;
+    BigInteger getOne() const; // Montgomery form of 1
+
+    BigInteger toMont(const BigInteger& a) const; // a*R mod N, any a
+    BigInteger fromMont(const BigInteger& a) const; // a*R^-1 mod N
+    BigInteger montMul(const BigInteger& a, const BigInteger& b) const; // a*b*R^-1 mod N, a and b below N
+    BigInteger montSqr(const BigInteger& a) const; // a*a*R^-1 mod N, about a third cheaper than montMul
+    BigInteger power(const BigInteger& a, const BigInteger& e) const; // a^e with a and the result in Montgomery form
+
+    static int windowSize(size_t bits); // sliding window width for an exponent of this length
+
+private:
+    LimbVector multiply(const LimbVector& a, const LimbVector& b) const;
+    LimbVector square(const LimbVector& a) const;
+    void reduce(LimbVector& t) const;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "LimbKernels.h"
+#include "NTTMultiply.h"
+
+// One transform prime p = c * 2^40 + 1 just below 2^63, with its arithmetic kept in
+// Montgomery form (x * 2^64 mod p) so that no step needs a 128-bit division.
+struct NTTPrime {
+    limb_t p;
+    limb_t root; // primitive root mod p
+    limb_t pinv; // -p^-1 mod 2^64
+    limb_t r2;   // 2^128 mod p, converts a plain residue into Montgomery form
+};
+
+
+static NTTPrime makePrime(limb_t p, limb_t root) {
+    NTTPrime prime;
+    prime.p = p;
+    prime.root = root;
+    prime.pinv = 0 - mpn_binvert_limb(p);
+
+    limb_t r = (0 - p) % p;
+    prime.r2 = (limb_t) ((dlimb_t) r * r % p);
+    return prime;
+}
+
+
+// Their product is about 2^189, which bounds every coefficient of a convolution of
+// 64-bit limbs (n * 2^128) for any n the 2^40 transform length allows.
+static const NTTPrime PRIMES[3] = {
+    makePrime(9223369837831520257ULL, 7),
+    makePrime(9223353345157103617ULL, 5),
+    makePrime(9223346748087336961ULL, 7)
+};
+
+
+static inline limb_t montMul(limb_t a, limb_t b, const NTTPrime& P) {
+    dlimb_t t = (dlimb_t) a * b;
+    limb_t m = (limb_t) t * P.pinv;
+    limb_t u = (limb_t) ((t + (dlimb_t) m * P.p) >> 64);
+    return u >= P.p ? u - P.p : u;
+}
+
+
+static inline limb_t addMod(limb_t a, limb_t b, const NTTPrime& P) {
+    limb_t s = a + b;
+    return s >= P.p ? s - P.p : s;
+}
+
+
+static inline limb_t subMod(limb_t a, limb_t b, const NTTPrime& P) {
+    return a >= b ? a - b : a + P.p - b;
+}
+
+
+static inline limb_t toMont(limb_t a, const NTTPrime& P) {
+    return montMul(a % P.p, P.r2, P);
+}
+
+
+// base and result in Montgomery form
+static limb_t powMod(limb_t base, limb_t exponent, const NTTPrime& P) {
+    limb_t result = toMont(1, P);
+    while (exponent > 0) {
+        if (exponent & 1)
+            result = montMul(result, base, P);
+        base = montMul(base, base, P);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+
+// iterative radix-2 transform, in place, values in Montgomery form
+static void transform(vector<limb_t>& a, bool inverse, const NTTPrime& P) {
+    size_t n = a.size();
+
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            swap(a[i], a[j]);
+    }
+
+    vector<limb_t> roots(n / 2);
+    limb_t root = toMont(P.root, P);
+    for (size_t len = 2; len <= n; len <<= 1) {
+        limb_t step = (P.p - 1) / len;
+        limb_t w = powMod(root, inverse ? P.p - 1 - step : step, P);
+        size_t half = len / 2;
+
+        roots[0] = toMont(1, P);
+        for (size_t j = 1; j < half; j++)
+            roots[j] = montMul(roots[j - 1], w, P);
+
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < half; j++) {
+                limb_t u = a[i + j];
+                limb_t v = montMul(a[i + j + half], roots[j], P);
+                a[i + j] = addMod(u, v, P);
+                a[i + j + half] = subMod(u, v, P);
+            }
+        }
+    }
+}
+
+
+// cyclic convolution of a and b modulo one prime, returned as plain residues
+static vector<limb_t> convolve(const LimbVector& a, const LimbVector& b, size_t n, const NTTPrime& P) {
+    vector<limb_t> fa(n, 0), fb(n, 0);
+    for (size_t i = 0; i < a.size(); i++)
+        fa[i] = toMont(a[i], P);
+    for (size_t i = 0; i < b.size(); i++)
+        fb[i] = toMont(b[i], P);
+
+    transform(fa, false, P);
+    transform(fb, false, P);
+    for (size_t i = 0; i < n; i++)
+        fa[i] = montMul(fa[i], fb[i], P);
+    transform(fa, true, P);
+
+    // multiplying a Montgomery value by a plain one leaves a plain result,
+    // so scaling by the plain n^-1 also converts out of Montgomery form
+    limb_t nInv = montMul(powMod(toMont(n, P), P.p - 2, P), 1, P);
+    for (size_t i = 0; i < n; i++)
+        fa[i] = montMul(fa[i], nInv, P);
+    return fa;
+}
+
+
+// plain x^-1 mod P in Montgomery form, so montMul(v, inverse) yields plain v / x
+static limb_t inverseMont(limb_t x, const NTTPrime& P) {
+    return powMod(toMont(x, P), P.p - 2, P);
+}
+
+
+LimbVector nttMultiply(const LimbVector& a, const LimbVector& b) {
+    if (a.empty() || b.empty())
+        return LimbVector();
+
+    size_t resultSize = a.size() + b.size();
+    size_t n = 1;
+    while (n < resultSize - 1)
+        n <<= 1;
+
+    const NTTPrime& P0 = PRIMES[0];
+    const NTTPrime& P1 = PRIMES[1];
+    const NTTPrime& P2 = PRIMES[2];
+    vector<limb_t> r0 = convolve(a, b, n, P0);
+    vector<limb_t> r1 = convolve(a, b, n, P1);
+    vector<limb_t> r2 = convolve(a, b, n, P2);
+
+    // Garner: x = r0 + p0 * t1 + p0 * p1 * t2
+    limb_t inv01 = inverseMont(P0.p, P1);
+    limb_t inv02 = inverseMont(P0.p, P2);
+    limb_t inv12 = inverseMont(P1.p, P2);
+    dlimb_t p01 = (dlimb_t) P0.p * P1.p;
+    limb_t p01lo = (limb_t) p01, p01hi = (limb_t) (p01 >> 64);
+
+    LimbVector res(resultSize, 0);
+    limb_t c0 = 0, c1 = 0, c2 = 0; // carry into the next limb, up to 192 bits
+    for (size_t i = 0; i < resultSize; i++) {
+        limb_t x0 = 0, x1 = 0, x2 = 0;
+        if (i < n) {
+            // every residue is below 2^63 and the primes are within a factor of two of each other
+            limb_t v0 = r0[i];
+            limb_t t1 = montMul(subMod(r1[i], v0 % P1.p, P1), inv01, P1);
+            limb_t t2 = montMul(subMod(r2[i], v0 % P2.p, P2), inv02, P2);
+            t2 = montMul(subMod(t2, t1 % P2.p, P2), inv12, P2);
+
+            dlimb_t s = (dlimb_t) P0.p * t1 + v0;
+            dlimb_t m0 = (dlimb_t) p01lo * t2;
+            dlimb_t m1 = (dlimb_t) p01hi * t2 + (limb_t) (m0 >> 64);
+
+            dlimb_t t = (dlimb_t) (limb_t) m0 + (limb_t) s;
+            x0 = (limb_t) t;
+            t = (t >> 64) + (limb_t) m1 + (limb_t) (s >> 64);
+            x1 = (limb_t) t;
+            x2 = (limb_t) (t >> 64) + (limb_t) (m1 >> 64);
+        }
+
+        dlimb_t t = (dlimb_t) c0 + x0;
+        res[i] = (limb_t) t;
+        t = (t >> 64) + c1 + x1;
+        c0 = (limb_t) t;
+        t = (t >> 64) + c2 + x2;
+        c1 = (limb_t) t;
+        c2 = (limb_t) (t >> 64);
+    }
+
+    while (!res.empty() && res.back() == 0)
+        res.pop_back();
+    return res;
+}
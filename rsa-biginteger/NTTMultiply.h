@@ -0,0 +1,12 @@
+#ifndef NTTMULTIPLY_H
+#define NTTMULTIPLY_H
+
+#include <vector>
+#include "BigInteger.h"
+
+// Multiplies two magnitudes (least significant limb first) with a number-theoretic
+// transform over three 63-bit primes and recombines the convolution with CRT.
+// Exact for any operand size up to 2^40 limbs of result.
+LimbVector nttMultiply(const LimbVector& a, const LimbVector& b);
+
+#endif
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include "GCD.h"
+#include "LimbPool.h"
+#include "Primality.h"
+#include "RandomSource.h"
+
+static const int SMALL_PRIMES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41};
+
+// The first `bases` primes decide every n below `bound` exactly (Jaeschke 1993,
+// Sorenson and Webster 2015).
+struct DeterministicBases {
+    const char* bound;
+    int bases;
+};
+
+static const DeterministicBases DETERMINISTIC[] = {
+    {"2047", 1},
+    {"1373653", 2},
+    {"25326001", 3},
+    {"3215031751", 4},
+    {"2152302898747", 5},
+    {"3474749660383", 6},
+    {"341550071728321", 7},
+    {"3825123056546413051", 9},
+    {"318665857834031151167461", 12},
+    {"3317044064679887385961981", 13},
+};
+
+static const size_t SIEVE_PRIMES = 2048;
+static const size_t WINDOW = 4096; // odd candidates per window
+static const limb_t MAX_PRIMORIAL_BOUND = (limb_t) 1 << 20;
+
+
+// the first SIEVE_PRIMES odd primes by the sieve of Eratosthenes, built once
+static const vector<limb_t>& sievingPrimes() {
+    static const vector<limb_t> primes = [] {
+        vector<limb_t> found;
+        vector<char> composite(18000, 0);
+        for (limb_t i = 3; found.size() < SIEVE_PRIMES; i += 2) {
+            if (composite[i])
+                continue;
+            found.push_back(i);
+            for (limb_t j = i * i; j < composite.size(); j += 2 * i)
+                composite[j] = 1;
+        }
+        return found;
+    }();
+    return primes;
+}
+
+
+// uniform in [2, n - 2], from this thread's generator
+static BigInteger randomBase(const BigInteger& n) {
+    return RandomSource::forThread().randomBelow(n - 3) + 2;
+}
+
+
+//-------------------------------------- MillerRabin ---------------------------------------------------------
+MillerRabin::MillerRabin(const BigInteger& n) : ctx(n) {
+    d = n - 1;
+    s = d.countTrailingZeros();
+    d >>= s;
+    minusOne = n - ctx.getOne();
+}
+
+
+// a prime n has a^d = 1 or a^(2^j * d) = -1 for some j < s. Reaching 1 any other way
+// means the value squared before it was a square root of 1 other than +-1
+bool MillerRabin::isWitness(const BigInteger& a) const {
+    BigInteger x = ctx.power(ctx.toMont(a), d);
+    if (x == ctx.getOne() || x == minusOne)
+        return false;
+    for (size_t j = 1; j < s; j++) {
+        x = ctx.montSqr(x);
+        if (x == minusOne)
+            return false;
+        if (x == ctx.getOne())
+            return true;
+    }
+    return true;
+}
+
+
+bool MillerRabin::isProbablePrime(int errorBits) const {
+    LimbPool::Scope scope;
+    BigInteger n = ctx.getModulus();
+    if (n.bitLength() <= 82) {
+        for (size_t i = 0; i < sizeof(DETERMINISTIC) / sizeof(DETERMINISTIC[0]); i++) {
+            if (n < BigInteger(DETERMINISTIC[i].bound)) {
+                for (int j = 0; j < DETERMINISTIC[i].bases; j++) {
+                    if (isWitness(SMALL_PRIMES[j]))
+                        return false;
+                }
+                return true;
+            }
+        }
+    }
+
+    int rounds = (errorBits + 1) / 2;
+    for (int i = 0; i < rounds; i++) {
+        if (isWitness(randomBase(n)))
+            return false;
+    }
+    return true;
+}
+
+
+//-------------------------------------- Primorial filter ----------------------------------------------------
+// the product of the primes up to x is about e^x, so P has about as many bits as the
+// candidates when the bound is their bit length times ln 2
+limb_t primorialBound(size_t bits) {
+    return min((limb_t) bits * 69 / 100, MAX_PRIMORIAL_BOUND);
+}
+
+
+// the odd primes up to the bound, multiplied pairwise up a product tree so that the
+// large products are balanced and go through the fast multiplication
+static BigInteger buildPrimorial(limb_t bound) {
+    vector<char> composite(bound + 1, 0);
+    vector<BigInteger> level;
+    for (limb_t i = 3; i <= bound; i += 2) {
+        if (composite[i])
+            continue;
+        level.push_back((BigInteger) (int) i);
+        for (limb_t j = i * i; j <= bound; j += 2 * i)
+            composite[j] = 1;
+    }
+    if (level.empty())
+        return 1;
+
+    while (level.size() > 1) {
+        vector<BigInteger> above((level.size() + 1) / 2);
+        for (size_t i = 0; i < above.size(); i++)
+            above[i] = 2 * i + 1 < level.size() ? level[2 * i] * level[2 * i + 1] : level[2 * i];
+        level.swap(above);
+    }
+    return level[0];
+}
+
+
+// cached per bound, so per candidate length when the bound is picked from it; map
+// nodes never move, so the reference stays valid after the lock is dropped
+const BigInteger& oddPrimorial(limb_t bound) {
+    static mutex lock;
+    static map<limb_t, BigInteger> cache;
+
+    bound = min(bound, MAX_PRIMORIAL_BOUND);
+    lock_guard<mutex> guard(lock);
+    map<limb_t, BigInteger>::iterator it = cache.find(bound);
+    if (it == cache.end())
+        it = cache.insert(make_pair(bound, buildPrimorial(bound))).first;
+    return it->second;
+}
+
+
+// n is above every prime in P, so any common factor is a proper one
+static bool sharesFactor(const BigInteger& n, const BigInteger& remainder) {
+    return BigInteger::compare(gcdMagnitude(n.getLimbs(), remainder.getLimbs()), LimbVector(1, 1)) != 0;
+}
+
+
+bool hasSmallFactor(const BigInteger& n, limb_t bound) {
+    bound = min(bound == 0 ? primorialBound(n.bitLength()) : bound, MAX_PRIMORIAL_BOUND);
+    if (n <= (int) bound)
+        throw domain_error("hasSmallFactor: n must be above the bound");
+    return sharesFactor(n, oddPrimorial(bound) % n);
+}
+
+
+//-------------------------------------- Entry point ---------------------------------------------------------
+bool isProbablePrime(const BigInteger& n, int errorBits) {
+    if (n < 2)
+        return false;
+    // also settles every n <= 41, so MillerRabin only sees n with all small bases below it
+    for (size_t i = 0; i < sizeof(SMALL_PRIMES) / sizeof(SMALL_PRIMES[0]); i++) {
+        if (n == SMALL_PRIMES[i])
+            return true;
+        if (n.divisibleBy(SMALL_PRIMES[i]))
+            return false;
+    }
+    if (hasSmallFactor(n))
+        return false;
+    return MillerRabin(n).isProbablePrime(errorBits);
+}
+
+
+//-------------------------------------- CandidateSieve ------------------------------------------------------
+CandidateSieve::CandidateSieve(const BigInteger& start) : base(start), composite(WINDOW) {
+    const vector<limb_t>& primes = sievingPrimes();
+    if (start <= (int) primes.back())
+        throw domain_error("CandidateSieve: start must be above the largest sieving prime");
+    if (base.isEven())
+        base++;
+
+    residues.resize(primes.size());
+    for (size_t i = 0; i < primes.size(); i++)
+        residues[i] = base.modLimb(primes[i]);
+    sieveWindow();
+}
+
+
+// base + 2i is a multiple of p from i = -r / 2 mod p on, and 2^-1 mod p is (p + 1) / 2
+void CandidateSieve::sieveWindow() {
+    const vector<limb_t>& primes = sievingPrimes();
+    fill(composite.begin(), composite.end(), 0);
+    for (size_t i = 0; i < primes.size(); i++) {
+        limb_t p = primes[i];
+        limb_t first = residues[i] == 0 ? 0 : (p - residues[i]) * ((p + 1) / 2) % p;
+        for (limb_t j = first; j < WINDOW; j += p)
+            composite[j] = 1;
+    }
+    slot = 0;
+}
+
+
+BigInteger CandidateSieve::next() {
+    while (true) {
+        for (; slot < WINDOW; slot++) {
+            if (!composite[slot])
+                return base + 2 * (int) slot++;
+        }
+
+        const vector<limb_t>& primes = sievingPrimes();
+        for (size_t i = 0; i < primes.size(); i++)
+            residues[i] = (residues[i] + 2 * WINDOW) % primes[i];
+        base += 2 * (int) WINDOW;
+        sieveWindow();
+    }
+}
+
+
+// survivors of the sieve have no factor below 17881, so they go straight to Miller-Rabin
+BigInteger nextProbablePrime(const BigInteger& start, int errorBits) {
+    BigInteger n = start;
+    while (n <= (int) sievingPrimes().back()) {
+        if (isProbablePrime(n, errorBits))
+            return n;
+        n++;
+    }
+
+    LimbPool::Scope scope;
+    CandidateSieve sieve(n);
+    while (true) {
+        BigInteger candidate = sieve.next();
+        if (MillerRabin(candidate).isProbablePrime(errorBits))
+            return candidate;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef PRIMALITY_H
+#define PRIMALITY_H
+
+#include <vector>
+#include "BigInteger.h"
+#include "MontgomeryContext.h"
+
+//-------------------------------------------------------------
+// Miller-Rabin test for one odd candidate n > 3. n - 1 = 2^s * d is factored once,
+// and each base costs one exponentiation a^d followed by at most s - 1 squarings,
+// all in Montgomery form modulo n, so a round never divides.
+class MillerRabin {
+private:
+    MontgomeryContext ctx;
+    BigInteger d;        // odd part of n - 1
+    size_t s;            // n - 1 = 2^s * d
+    BigInteger minusOne; // n - 1 in Montgomery form
+
+public:
+    MillerRabin(const BigInteger& n); // n odd and above 3
+
+    // true when a proves n composite, 2 <= a <= n - 2
+    bool isWitness(const BigInteger& a) const;
+    // No composite passes the deterministic base sets below 3.3 * 10^24. Above that,
+    // bases are random and each round lets a composite through with probability at
+    // most 1/4, so errorBits / 2 rounds bound the error by 2^-errorBits.
+    bool isProbablePrime(int errorBits) const;
+};
+
+//-------------------------------------------------------------
+// Trial division by every odd prime up to a bound through one gcd: n has such a factor
+// exactly when gcd(n, P) > 1 for the product P of those primes. Each P is built once
+// and cached. A bound of 0 picks one from the bit length of n so that P is about as
+// long, which keeps the gcd far cheaper than a single Miller-Rabin round. Bounds are
+// capped at 2^20, and n must be above the bound.
+limb_t primorialBound(size_t bits);
+const BigInteger& oddPrimorial(limb_t bound);
+bool hasSmallFactor(const BigInteger& n, limb_t bound = 0);
+
+// primality of any n, with the error bound of MillerRabin::isProbablePrime. Composites
+// with a small factor are rejected by trial division and hasSmallFactor first.
+bool isProbablePrime(const BigInteger& n, int errorBits = 100);
+
+//-------------------------------------------------------------
+// The odd numbers from a starting point with every multiple of the first 2048 odd
+// primes (3 to 17881) struck out, which removes about 89% of them. The start's
+// residues modulo those primes are computed once; each window of candidates is
+// sieved from the residues, which are then advanced by the window's width, so after
+// construction no big number is ever divided.
+class CandidateSieve {
+private:
+    BigInteger base;          // the odd number slot 0 of the window stands for
+    vector<limb_t> residues;  // base mod each sieving prime
+    vector<char> composite;   // slot i stands for base + 2i
+    size_t slot;              // next slot to look at
+
+    void sieveWindow();
+
+public:
+    CandidateSieve(const BigInteger& start); // start above the largest sieving prime
+
+    BigInteger next(); // the next odd number >= start with no sieving prime as a factor
+};
+
+// smallest probable prime >= start
+BigInteger nextProbablePrime(const BigInteger& start, int errorBits = 100);
+
+#endif
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "LimbPool.h"
+#include "Primality.h"
+#include "PrimeSearch.h"
+#include "RandomSource.h"
+
+// one search shared by its workers; the first prime offered wins
+struct PrimeSearch {
+    int bits;
+    int errorBits;
+    atomic<bool> done;
+    mutex lock;
+    BigInteger result;
+
+    PrimeSearch(int bits, int errorBits) : bits(bits), errorBits(errorBits), done(false) {}
+
+    void offer(const BigInteger& prime) {
+        lock_guard<mutex> guard(lock);
+        if (!done) {
+            result = prime;
+            done = true;
+        }
+    }
+};
+
+
+// odd, exactly bits long, with the top two bits set
+static BigInteger randomStart(int bits) {
+    BigInteger start = RandomSource::forThread().randomWithBits(bits);
+    start.setBit(bits - 2);
+    start.setBit(0);
+    return start;
+}
+
+
+// a start that walks past 2^bits before reaching a prime is dropped for a fresh one;
+// starts come from the worker thread's own generator
+static void worker(PrimeSearch& search) {
+    LimbPool::Scope scope;
+    while (!search.done) {
+        CandidateSieve sieve(randomStart(search.bits));
+        while (!search.done) {
+            BigInteger candidate = sieve.next();
+            if ((int) candidate.bitLength() != search.bits)
+                break;
+            if (MillerRabin(candidate).isProbablePrime(search.errorBits)) {
+                search.offer(candidate);
+                return;
+            }
+        }
+    }
+}
+
+
+static int workerCount(int threads) {
+    if (threads > 0)
+        return threads;
+    int hardware = (int) thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+
+// starts `threads` workers on each search and waits for all of them
+static void run(PrimeSearch* searches[], int count, int threads) {
+    if (searches[0]->bits < 16)
+        throw domain_error("generatePrime: at least 16 bits are needed");
+
+    vector<thread> workers;
+    for (int s = 0; s < count; s++) {
+        for (int i = 0; i < threads; i++)
+            workers.push_back(thread(worker, ref(*searches[s])));
+    }
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+
+BigInteger generatePrime(int bits, int threads, int errorBits) {
+    PrimeSearch search(bits, errorBits);
+    PrimeSearch* searches[] = {&search};
+    run(searches, 1, workerCount(threads));
+    return search.result;
+}
+
+
+void generatePrimePair(int bits, BigInteger& p, BigInteger& q, int threads, int errorBits) {
+    PrimeSearch first(bits, errorBits), second(bits, errorBits);
+    PrimeSearch* searches[] = {&first, &second};
+    run(searches, 2, max(workerCount(threads) / 2, 1));
+    p = first.result;
+    q = second.result;
+
+    // two independent draws meeting is astronomically unlikely, but p = q breaks RSA
+    while (p == q)
+        q = generatePrime(bits, threads, errorBits);
+}
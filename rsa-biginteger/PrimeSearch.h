@@ -0,0 +1,18 @@
+#ifndef PRIMESEARCH_H
+#define PRIMESEARCH_H
+
+#include "BigInteger.h"
+
+//-------------------------------------------------------------
+// Random primes of an exact bit length (at least 16), with the top two bits set so
+// that the product of two of them has exactly twice as many. The search runs on
+// `threads` workers, or one per hardware thread when threads is 0. Every worker draws
+// its own random start from its thread's RandomSource and walks it through a
+// CandidateSieve. The first to confirm a prime publishes it and raises a flag that the
+// others check between candidates, so they stop within one Miller-Rabin test.
+BigInteger generatePrime(int bits, int threads = 0, int errorBits = 100);
+
+// p and q for an RSA modulus, searched at the same time by two halves of the workers
+void generatePrimePair(int bits, BigInteger& p, BigInteger& q, int threads = 0, int errorBits = 100);
+
+#endif
@@ -0,0 +1,158 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "RandomSource.h"
+
+
+//-------------------------------------- Draws ---------------------------------------------------------------
+limb_t RandomSource::nextLimb() {
+    limb_t x;
+    fill(&x, 1);
+    return x;
+}
+
+
+BigInteger RandomSource::randomBits(size_t bits) {
+    LimbVector limbs((bits + 63) / 64);
+    fill(limbs.data(), limbs.size());
+    if (bits % 64 != 0)
+        limbs.back() &= ((limb_t) 1 << (bits % 64)) - 1;
+    BigInteger r;
+    r.setLimbs(limbs);
+    return r;
+}
+
+
+BigInteger RandomSource::randomWithBits(size_t bits) {
+    BigInteger r = randomBits(bits - 1);
+    r.setBit(bits - 1);
+    return r;
+}
+
+
+// rejection sampling on bound's bit length takes fewer than two draws on average
+BigInteger RandomSource::randomBelow(const BigInteger& bound) {
+    size_t bits = bound.bitLength();
+    BigInteger r = randomBits(bits);
+    while (r >= bound)
+        r = randomBits(bits);
+    return r;
+}
+
+
+RandomSource& RandomSource::forThread() {
+    static thread_local ChaCha20Random generator;
+    return generator;
+}
+
+
+//-------------------------------------- ChaCha20 ------------------------------------------------------------
+static void systemEntropy(uint8_t* out, size_t length) {
+    size_t done = 0;
+#ifdef SYS_getrandom
+    while (done < length) {
+        long got = syscall(SYS_getrandom, out + done, length - done, 0);
+        if (got < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        done += got;
+    }
+#endif
+    if (done == length)
+        return;
+
+    FILE* urandom = fopen("/dev/urandom", "rb");
+    bool ok = urandom != NULL && fread(out, 1, length, urandom) == length;
+    if (urandom != NULL)
+        fclose(urandom);
+    if (!ok)
+        throw runtime_error("ChaCha20Random: no system entropy available");
+}
+
+
+ChaCha20Random::ChaCha20Random() {
+    uint8_t key[32];
+    systemEntropy(key, sizeof(key));
+    setKey(key, 0);
+    memset(key, 0, sizeof(key));
+}
+
+
+ChaCha20Random::ChaCha20Random(const uint8_t key[32], uint64_t stream) {
+    setKey(key, stream);
+}
+
+
+// "expand 32-byte k", the key as little-endian words, then block counter and stream
+void ChaCha20Random::setKey(const uint8_t key[32], uint64_t stream) {
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++) {
+        state[4 + i] = (uint32_t) key[4 * i] | (uint32_t) key[4 * i + 1] << 8
+                     | (uint32_t) key[4 * i + 2] << 16 | (uint32_t) key[4 * i + 3] << 24;
+    }
+    state[12] = 0;
+    state[13] = 0;
+    state[14] = (uint32_t) stream;
+    state[15] = (uint32_t) (stream >> 32);
+    used = 8;
+}
+
+
+static inline uint32_t rotateLeft(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+
+static inline void quarterRound(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d) {
+    a += b; d = rotateLeft(d ^ a, 16);
+    c += d; b = rotateLeft(b ^ c, 12);
+    a += b; d = rotateLeft(d ^ a, 8);
+    c += d; b = rotateLeft(b ^ c, 7);
+}
+
+
+// ten double rounds of column and diagonal quarter rounds, then the input added back
+void ChaCha20Random::nextBlock(limb_t* out) {
+    uint32_t x[16];
+    memcpy(x, state, sizeof(x));
+    for (int i = 0; i < 10; i++) {
+        quarterRound(x[0], x[4], x[8], x[12]);
+        quarterRound(x[1], x[5], x[9], x[13]);
+        quarterRound(x[2], x[6], x[10], x[14]);
+        quarterRound(x[3], x[7], x[11], x[15]);
+        quarterRound(x[0], x[5], x[10], x[15]);
+        quarterRound(x[1], x[6], x[11], x[12]);
+        quarterRound(x[2], x[7], x[8], x[13]);
+        quarterRound(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 8; i++)
+        out[i] = (limb_t) (x[2 * i] + state[2 * i]) | (limb_t) (x[2 * i + 1] + state[2 * i + 1]) << 32;
+
+    if (++state[12] == 0)
+        state[13]++;
+}
+
+
+void ChaCha20Random::fill(limb_t* limbs, size_t count) {
+    size_t i = 0;
+    while (i < count && used < 8)
+        limbs[i++] = buffer[used++];
+    for (; count - i >= 8; i += 8)
+        nextBlock(limbs + i);
+    if (i < count) {
+        nextBlock(buffer);
+        used = 0;
+        while (i < count)
+            limbs[i++] = buffer[used++];
+    }
+}
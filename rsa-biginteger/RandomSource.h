@@ -0,0 +1,47 @@
+#ifndef RANDOMSOURCE_H
+#define RANDOMSOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "BigInteger.h"
+
+//-------------------------------------------------------------
+// Source of random limbs for key generation. A generator only has to fill limb buffers;
+// the BigInteger draws on top of it are shared. forThread() hands out one ChaCha20
+// generator per thread, seeded from the operating system on first use, so parallel
+// searches never share or lock generator state.
+class RandomSource {
+public:
+    virtual ~RandomSource() {}
+    virtual void fill(limb_t* limbs, size_t count) = 0;
+
+    limb_t nextLimb();
+    BigInteger randomBits(size_t bits);            // uniform in [0, 2^bits)
+    BigInteger randomWithBits(size_t bits);        // uniform in [2^(bits - 1), 2^bits), bits >= 1
+    BigInteger randomBelow(const BigInteger& bound); // uniform in [0, bound), bound > 0
+
+    static RandomSource& forThread();
+};
+
+//-------------------------------------------------------------
+// ChaCha20 (Bernstein 2008, RFC 8439) as a stream of random limbs: the 20-round block
+// function over a 256-bit key, a 64-bit block counter and a 64-bit stream number, eight
+// limbs per block. Requests of whole blocks are written straight into the caller's buffer.
+class ChaCha20Random : public RandomSource {
+private:
+    uint32_t state[16];
+    limb_t buffer[8];
+    size_t used; // limbs of buffer already handed out
+
+public:
+    ChaCha20Random(); // keyed from getrandom(), or /dev/urandom where it is missing
+    ChaCha20Random(const uint8_t key[32], uint64_t stream = 0); // reproducible stream
+
+    void fill(limb_t* limbs, size_t count);
+
+private:
+    void setKey(const uint8_t key[32], uint64_t stream);
+    void nextBlock(limb_t* out);
+};
+
+#endif
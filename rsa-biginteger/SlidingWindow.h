@@ -0,0 +1,44 @@
+#ifndef SLIDINGWINDOW_H
+#define SLIDINGWINDOW_H
+
+#include <algorithm>
+
+//-------------------------------------------------------------
+// Left-to-right sliding window exponentiation, shared by every Montgomery ladder:
+// the exponent's bits are scanned directly and each window of up to k bits ending
+// in a 1 costs one multiplication by a precomputed odd power, oddPowers[i] holding
+// a^(2i + 1). Value is whatever the ladder keeps its numbers in, Exponent anything
+// with bitLength() and testBit(), and square(x) and multiply(x, y) the ladder's own
+// Montgomery products. one is the ladder's form of 1, returned for a zero exponent.
+template <class Value, class Table, class Exponent, class Square, class Multiply>
+Value slidingWindow(const Value& one, const Table& oddPowers, const Exponent& e, int k,
+                    Square square, Multiply multiply) {
+    Value x = one;
+    bool started = false; // squaring 1 is wasted work, skip it until the first window
+    long i = (long) e.bitLength() - 1;
+    while (i >= 0) {
+        if (!e.testBit(i)) {
+            x = square(x);
+            i--;
+            continue;
+        }
+
+        // longest window starting at bit i that ends in a 1
+        long j = std::max(i - k + 1, 0L);
+        while (!e.testBit(j))
+            j++;
+
+        int value = 0;
+        for (long l = i; l >= j; l--) {
+            value = (value << 1) | e.testBit(l);
+            if (started)
+                x = square(x);
+        }
+        x = started ? multiply(x, oddPowers[value >> 1]) : oddPowers[value >> 1];
+        started = true;
+        i = j - 1;
+    }
+    return x;
+}
+
+#endif
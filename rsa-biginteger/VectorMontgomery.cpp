@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <stdexcept>
+#include "BigInteger.h"
+#include "LimbKernels.h"
+#include "MontgomeryContext.h"
+#include "SlidingWindow.h"
+#include "VectorMontgomery.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define VECTOR_KERNELS
+#include <immintrin.h>
+#endif
+
+// Bounds every lane sum: a lane takes at most four products below 2^52 per row for
+// IFMA and two below 2^52 for AVX2, so 16384-bit moduli keep them below 2^63.
+static const size_t MAX_LIMBS = 256;
+static const size_t MAX_DIGITS = (MAX_LIMBS * 64 + 2 + 25) / 26;
+static const size_t MAX_PADDED = MAX_DIGITS + 8;
+
+// Conservative crossovers against the scalar ladder for a full-length exponent, from
+// rsa_benchmark runs on more than one host: IFMA breaks even around 768 bits and AVX2
+// only wins from about 3072 bits. rsa_benchmark calibrates the host's own crossover.
+static const size_t DEFAULT_THRESHOLD[] = {0, 48, 12};
+static size_t vectorThreshold = 0; // 0 for the active kernel's default
+
+
+static VectorMontgomery::Kernel& kernelInUse() {
+    static VectorMontgomery::Kernel kernel = VectorMontgomery::detect();
+    return kernel;
+}
+
+
+//-------------------------------------- Kernels -------------------------------------------------------------
+// carries of the redundant digits propagated up, leaving every digit below 2^bits
+static void normalize(limb_t* r, const limb_t* t, size_t digits, size_t padded, unsigned bits) {
+    limb_t mask = ((limb_t) 1 << bits) - 1, carry = 0;
+    for (size_t j = 0; j < digits; j++) {
+        limb_t x = t[j] + carry;
+        r[j] = x & mask;
+        carry = x >> bits;
+    }
+    for (size_t j = digits; j < padded; j++)
+        r[j] = 0;
+}
+
+#ifdef VECTOR_KERNELS
+// One row per digit of b: add a*b[i] and y*N, with y picked so that the lowest digit
+// becomes a multiple of 2^52, then move every lane down one place, handing the lowest
+// digit's carry to the next. The low halves of the products go in before the move and
+// the high halves after it, which puts them one digit further up. y only depends on the
+// lowest lane, so it is computed in scalar registers ahead of the vector work.
+__attribute__((target("avx512f,avx512ifma")))
+static void multiplyIFMA(limb_t* r, const limb_t* a, const limb_t* b, const limb_t* n,
+                         limb_t k0, size_t digits, size_t vectors) {
+    const limb_t mask = ((limb_t) 1 << 52) - 1;
+    __m512i acc[MAX_DIGITS / 8 + 1], av[MAX_DIGITS / 8 + 1], nv[MAX_DIGITS / 8 + 1];
+    const __m512i zero = _mm512_setzero_si512();
+    for (size_t v = 0; v < vectors; v++) {
+        acc[v] = zero;
+        av[v] = _mm512_loadu_si512(a + 8 * v);
+        nv[v] = _mm512_loadu_si512(n + 8 * v);
+    }
+
+    for (size_t i = 0; i < digits; i++) {
+        limb_t low = (limb_t) _mm_cvtsi128_si64(_mm512_castsi512_si128(acc[0])) + ((a[0] * b[i]) & mask);
+        limb_t y = (low * k0) & mask;
+        limb_t carry = (low + ((y * n[0]) & mask)) >> 52;
+        __m512i bi = _mm512_set1_epi64(b[i]), yv = _mm512_set1_epi64(y);
+
+        for (size_t v = 0; v < vectors; v++)
+            acc[v] = _mm512_madd52lo_epu64(_mm512_madd52lo_epu64(acc[v], av[v], bi), nv[v], yv);
+        for (size_t v = 0; v + 1 < vectors; v++)
+            acc[v] = _mm512_alignr_epi64(acc[v + 1], acc[v], 1);
+        acc[vectors - 1] = _mm512_alignr_epi64(zero, acc[vectors - 1], 1);
+        acc[0] = _mm512_add_epi64(acc[0], _mm512_maskz_set1_epi64(1, carry));
+        for (size_t v = 0; v < vectors; v++)
+            acc[v] = _mm512_madd52hi_epu64(_mm512_madd52hi_epu64(acc[v], av[v], bi), nv[v], yv);
+    }
+
+    limb_t t[MAX_DIGITS + 8];
+    for (size_t v = 0; v < vectors; v++)
+        _mm512_storeu_si512(t + 8 * v, acc[v]);
+    normalize(r, t, digits, 8 * vectors, 52);
+}
+
+
+// The same rows with 26-bit digits, whose products fit a lane whole. AVX2 has no
+// shift across a 256-bit pair, so each vector is rotated by one lane and its top lane
+// taken from the rotated vector above it.
+__attribute__((target("avx2")))
+static void multiplyAVX2(limb_t* r, const limb_t* a, const limb_t* b, const limb_t* n,
+                         limb_t k0, size_t digits, size_t vectors) {
+    const limb_t mask = ((limb_t) 1 << 26) - 1;
+    __m256i acc[MAX_DIGITS / 4 + 1], av[MAX_DIGITS / 4 + 1], nv[MAX_DIGITS / 4 + 1];
+    const __m256i zero = _mm256_setzero_si256();
+    for (size_t v = 0; v < vectors; v++) {
+        acc[v] = zero;
+        av[v] = _mm256_loadu_si256((const __m256i*) (a + 4 * v));
+        nv[v] = _mm256_loadu_si256((const __m256i*) (n + 4 * v));
+    }
+
+    for (size_t i = 0; i < digits; i++) {
+        limb_t low = (limb_t) _mm_cvtsi128_si64(_mm256_castsi256_si128(acc[0])) + a[0] * b[i];
+        limb_t y = (low * k0) & mask;
+        limb_t carry = (low + y * n[0]) >> 26;
+        __m256i bi = _mm256_set1_epi64x(b[i]), yv = _mm256_set1_epi64x(y);
+
+        __m256i rotated = zero;
+        for (size_t v = vectors; v-- > 0; ) {
+            __m256i sum = _mm256_add_epi64(acc[v], _mm256_add_epi64(_mm256_mul_epu32(av[v], bi),
+                                                                      _mm256_mul_epu32(nv[v], yv)));
+            __m256i down = _mm256_permute4x64_epi64(sum, 0x39);
+            acc[v] = _mm256_blend_epi32(down, rotated, 0xC0);
+            rotated = down;
+        }
+        acc[0] = _mm256_add_epi64(acc[0], _mm256_set_epi64x(0, 0, 0, carry));
+    }
+
+    limb_t t[MAX_DIGITS + 4];
+    for (size_t v = 0; v < vectors; v++)
+        _mm256_storeu_si256((__m256i*) (t + 4 * v), acc[v]);
+    normalize(r, t, digits, 4 * vectors, 26);
+}
+#endif
+
+
+//-------------------------------------- VectorMontgomery ----------------------------------------------------
+// 2^shift mod N for either sign of shift; a negative one halves modulo N, adding N
+// first whenever the value is odd
+static BigInteger powerOfTwoMod(long shift, const BigInteger& mod) {
+    if (shift >= 0)
+        return (BigInteger(1) << (size_t) shift) % mod;
+    BigInteger x = 1;
+    for (long i = 0; i < -shift; i++) {
+        if (x.isOdd())
+            x += mod;
+        x >>= 1;
+    }
+    return x;
+}
+
+
+VectorMontgomery::VectorMontgomery(const LimbVector& modulus, Kernel kernel, size_t montgomeryBits)
+    : kernel(kernel) {
+    if (kernel == SCALAR)
+        throw domain_error("VectorMontgomery: no vector kernel");
+    if (modulus.empty() || (modulus[0] & 1) == 0 || modulus.size() > MAX_LIMBS)
+        throw domain_error("VectorMontgomery: modulus must be odd and at most 16384 bits");
+
+    size_t bits = 64 * modulus.size();
+    while (bits > 0 && ((modulus[(bits - 1) / 64] >> ((bits - 1) % 64)) & 1) == 0)
+        bits--;
+    digitBits = kernel == IFMA ? 52 : 26;
+    digits = (bits + 2 + digitBits - 1) / digitBits;
+    size_t lanes = kernel == IFMA ? 8 : 4;
+    padded = (digits + lanes - 1) / lanes * lanes;
+    m = modulus;
+    k0 = (0 - mpn_binvert_limb(modulus[0])) & (((limb_t) 1 << digitBits) - 1);
+
+    BigInteger mod;
+    mod.setLimbs(modulus);
+    auto digitsOf = [this](const BigInteger& a) {
+        LimbVector d(padded);
+        toDigits(d.data(), a.getLimbs().data(), a.getLimbs().size());
+        return d;
+    };
+    n = digitsOf(mod);
+    intoLanes = digitsOf(powerOfTwoMod(2 * (long) radixBits() - (long) montgomeryBits, mod));
+    outOfLanes = digitsOf(powerOfTwoMod((long) montgomeryBits, mod));
+    unit = digitsOf(powerOfTwoMod((long) radixBits(), mod));
+}
+
+
+void VectorMontgomery::toDigits(limb_t* d, const limb_t* a, size_t limbs) const {
+    limb_t mask = ((limb_t) 1 << digitBits) - 1;
+    for (size_t j = 0; j < padded; j++)
+        d[j] = 0;
+    for (size_t j = 0; j < digits; j++) {
+        size_t bit = j * digitBits, limb = bit / 64, shift = bit % 64;
+        if (limb >= limbs)
+            break;
+        limb_t x = a[limb] >> shift;
+        if (shift + digitBits > 64 && limb + 1 < limbs)
+            x |= a[limb + 1] << (64 - shift);
+        d[j] = x & mask;
+    }
+}
+
+
+void VectorMontgomery::fromDigits(limb_t* r, const limb_t* d) const {
+    size_t limbs = (digits * digitBits + 63) / 64;
+    for (size_t i = 0; i < limbs; i++)
+        r[i] = 0;
+    for (size_t j = 0; j < digits; j++) {
+        size_t bit = j * digitBits, limb = bit / 64, shift = bit % 64;
+        r[limb] |= d[j] << shift;
+        if (shift + digitBits > 64)
+            r[limb + 1] |= d[j] >> (64 - shift);
+    }
+}
+
+
+void VectorMontgomery::multiply(limb_t* r, const limb_t* a, const limb_t* b) const {
+#ifdef VECTOR_KERNELS
+    if (kernel == IFMA)
+        multiplyIFMA(r, a, b, n.data(), k0, digits, padded / 8);
+    else
+        multiplyAVX2(r, a, b, n.data(), k0, digits, padded / 4);
+#else
+    (void) r; (void) a; (void) b;
+#endif
+}
+
+
+void VectorMontgomery::enter(limb_t* r, const limb_t* a, size_t limbs) const {
+    limb_t d[MAX_PADDED];
+    toDigits(d, a, limbs);
+    multiply(r, d, intoLanes.data());
+}
+
+
+void VectorMontgomery::one(limb_t* r) const {
+    copy(unit.begin(), unit.end(), r);
+}
+
+
+// the product with R mod N is below 2N, which can take one bit past N's top limb
+void VectorMontgomery::leave(limb_t* r, const limb_t* a) const {
+    limb_t d[MAX_PADDED], t[MAX_LIMBS + 2];
+    size_t s = m.size();
+    multiply(d, a, outOfLanes.data());
+    t[s] = 0; // fromDigits() stops at the limbs the digits span, which may be only s
+    fromDigits(t, d);
+    if (t[s] != 0 || mpn_cmp(t, m.data(), s) >= 0)
+        mpn_sub_n(r, t, m.data(), s);
+    else
+        copy(t, t + s, r);
+}
+
+
+// the whole ladder runs on lane digits below 2N between one enter() and one leave()
+BigInteger VectorMontgomery::power(const BigInteger& a, const BigInteger& e) const {
+    auto product = [this](const LimbVector& x, const LimbVector& y) {
+        LimbVector t(padded);
+        multiply(t.data(), x.data(), y.data());
+        return t;
+    };
+    auto square = [&product](const LimbVector& x) { return product(x, x); };
+
+    int k = MontgomeryContext::windowSize(e.bitLength());
+    vector<LimbVector> oddPowers(1 << (k - 1), LimbVector(padded));
+    enter(oddPowers[0].data(), a.getLimbs().data(), a.getLimbs().size());
+    LimbVector aSquared = square(oddPowers[0]);
+    for (size_t i = 1; i < oddPowers.size(); i++)
+        oddPowers[i] = product(oddPowers[i - 1], aSquared);
+
+    LimbVector unitDigits(padded), limbs(m.size());
+    one(unitDigits.data());
+    leave(limbs.data(), slidingWindow(unitDigits, oddPowers, e, k, square, product).data());
+
+    BigInteger res;
+    res.setLimbs(limbs);
+    return res;
+}
+
+
+//-------------------------------------- Dispatch ------------------------------------------------------------
+// __builtin_cpu_supports also checks through XGETBV that the OS saves the vector
+// registers, so a kernel it reports can really run
+VectorMontgomery::Kernel VectorMontgomery::detect() {
+#ifdef VECTOR_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma"))
+        return IFMA;
+    if (__builtin_cpu_supports("avx2"))
+        return AVX2;
+#endif
+    return SCALAR;
+}
+
+
+VectorMontgomery::Kernel VectorMontgomery::activeKernel() {
+    return kernelInUse();
+}
+
+
+void VectorMontgomery::setKernel(Kernel kernel) {
+    Kernel best = detect();
+    if (kernel == IFMA && best != IFMA)
+        kernel = SCALAR;
+    if (kernel == AVX2 && best == SCALAR)
+        kernel = SCALAR;
+    kernelInUse() = kernel;
+}
+
+
+size_t VectorMontgomery::threshold() {
+    return vectorThreshold != 0 ? vectorThreshold : DEFAULT_THRESHOLD[kernelInUse()];
+}
+
+
+void VectorMontgomery::setThreshold(size_t limbs) {
+    vectorThreshold = limbs;
+}
+
+
+bool VectorMontgomery::usable(size_t limbs) {
+    return kernelInUse() != SCALAR && limbs >= threshold() && limbs <= MAX_LIMBS;
+}
+
+
+const char* VectorMontgomery::name(Kernel kernel) {
+    switch (kernel) {
+    case IFMA:
+        return "AVX-512 IFMA";
+    case AVX2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef VECTORMONTGOMERY_H
+#define VECTORMONTGOMERY_H
+
+#include <cstddef>
+#include "BigInteger.h"
+#include "LimbVector.h"
+
+//-------------------------------------------------------------
+// Montgomery multiplication across SIMD lanes, for the exponentiation ladder of
+// MontgomeryContext. Numbers are held in a redundant radix, one digit per 64-bit lane:
+// 52-bit digits for AVX-512 IFMA, whose vpmadd52luq / vpmadd52huq add the low and
+// high halves of 52x52-bit products, or 26-bit digits for AVX2, whose vpmuludq gives
+// whole 32x32-bit products. Each lane soaks up the products of a whole multiplication
+// and carries are propagated once at the end.
+//
+// With R' = 2^(digit bits * digits) > 4N the products are "almost Montgomery": inputs
+// below 2N give a*b*R'^-1 mod N plus at most one N, so nothing is compared or
+// subtracted until a value leaves the ladder. A value is padded with zero digits to
+// a whole number of vectors; size() is that length.
+//
+// A caller with its own Montgomery radix R = 2^montgomeryBits carries a*R to a*R' once
+// with enter() and back once with leave(), so its ladder can run in lanes in between.
+// Those work on raw spans with stack scratch and never allocate; power() is the whole
+// ladder on BigInteger for MontgomeryContext.
+class VectorMontgomery {
+public:
+    enum Kernel { SCALAR, AVX2, IFMA };
+
+private:
+    Kernel kernel;
+    unsigned digitBits;
+    size_t digits;  // R' = 2^(digitBits * digits) > 4N
+    size_t padded;  // digits rounded up to whole vectors
+    LimbVector n;   // N in digits
+    limb_t k0;      // -N^-1 mod 2^digitBits
+    LimbVector m;   // N in limbs
+    LimbVector intoLanes;  // R'^2 * R^-1 mod N in digits, takes a*R to a*R'
+    LimbVector outOfLanes; // R mod N in digits, takes a*R' back to a*R
+    LimbVector unit;       // R' mod N in digits, the form of 1 in lanes
+
+    void toDigits(limb_t* d, const limb_t* a, size_t limbs) const; // a below R' into size() digits
+    void fromDigits(limb_t* r, const limb_t* d) const; // normalized digits back to limbs
+
+public:
+    // odd modulus without leading zero limbs, kernel not SCALAR, montgomeryBits the
+    // caller's R = 2^montgomeryBits
+    VectorMontgomery(const LimbVector& modulus, Kernel kernel, size_t montgomeryBits);
+
+    size_t size() const { return padded; }
+    size_t limbs() const { return m.size(); }
+    size_t radixBits() const { return digitBits * digits; } // R' = 2^radixBits()
+
+    // r = a*b*R'^-1 mod N, below 2N, for a and b below 2N; r may be a or b
+    void multiply(limb_t* r, const limb_t* a, const limb_t* b) const;
+    // a*R in limbs limbs, below N, into a*R' in size() digits
+    void enter(limb_t* r, const limb_t* a, size_t limbs) const;
+    // 1 in size() digits
+    void one(limb_t* r) const;
+    // a*R' in size() digits, below 2N, back to a*R below N in limbs() limbs
+    void leave(limb_t* r, const limb_t* a) const;
+    // a^e for a below N in the caller's Montgomery form and e > 0, the result in that
+    // form and below N
+    BigInteger power(const BigInteger& a, const BigInteger& e) const;
+
+    // The kernel MontgomeryContext uses from threshold() limbs up, by default the best
+    // one CPUID reports and the OS has enabled. setKernel() falls back to SCALAR when
+    // the CPU lacks the one asked for, and setThreshold(0) restores the kernel's own
+    // crossover. Neither setter is safe while other threads run.
+    static Kernel detect();
+    static Kernel activeKernel();
+    static void setKernel(Kernel kernel);
+    static size_t threshold();
+    static void setThreshold(size_t limbs);
+    static bool usable(size_t limbs); // the active kernel takes moduli of this many limbs
+    static const char* name(Kernel kernel);
+};
+
+#endif
@@ -0,0 +1,651 @@
+#include <chrono>
+#include <iostream>
+#include <climits>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BatchExponentiation.h"
+#include "BigInteger.h"
+#include "FixedBigInt.h"
+#include "GCD.h"
+#include "LimbPool.h"
+#include "LimbVector.h"
+#include "MontgomeryContext.h"
+#include "Primality.h"
+#include "PrimeSearch.h"
+#include "RandomSource.h"
+#include "VectorMontgomery.h"
+
+#define MILLIS 1000
+
+using namespace std;
+
+
+// random number of roughly the given number of limbs
+BigInteger randomLimbs(int limbs) {
+    int digits = (int) (limbs * 64 * 0.30103);
+    string s(1, '1' + rand() % 9);
+    for (int i = 1; i < digits; i++)
+        s += (char) ('0' + rand() % 10);
+    return BigInteger(s);
+}
+
+
+// average time of one a * b in ms, repeated for at least 50 ms
+double timeMultiply(BigInteger a, BigInteger b) {
+    int reps = 0;
+    const clock_t begin_time = clock();
+    do {
+        BigInteger c = a * b;
+        reps++;
+    } while (clock() - begin_time < CLOCKS_PER_SEC / 20);
+    return float( clock () - begin_time ) * MILLIS / CLOCKS_PER_SEC / reps;
+}
+
+
+// average time of one a * a in ms, through square() or, with a distinct copy of a
+// as the right operand, through the general multiplication
+double timeSquare(const BigInteger& a, bool dedicated) {
+    BigInteger b = a;
+    int reps = 0;
+    const clock_t begin_time = clock();
+    do {
+        BigInteger c = dedicated ? a * a : a * b;
+        reps++;
+    } while (clock() - begin_time < CLOCKS_PER_SEC / 20);
+    return float( clock () - begin_time ) * MILLIS / CLOCKS_PER_SEC / reps;
+}
+
+
+// Finds the smallest operand size where one level of the faster algorithm beats the
+// slower one twice in a row. Recursion below the size under test keeps using the
+// slower settings, the same way GMP's tuneup measures its thresholds.
+// level 0 tunes the Karatsuba threshold, 1 the Toom-3 threshold and 2 the NTT threshold.
+int calibrate(string name, int level, int from, int to, int step, int karatsuba, int toom3) {
+    cout << "\n" << name << endl;
+    int wins = 0;
+    for (int n = from; n <= to; n += step) {
+        BigInteger a = randomLimbs(n), b = randomLimbs(n);
+
+        BigInteger::setMultiplyThresholds(level > 0 ? karatsuba : INT_MAX, level > 1 ? toom3 : INT_MAX, INT_MAX);
+        double slow = timeMultiply(a, b);
+        BigInteger::setMultiplyThresholds(level > 0 ? karatsuba : n, level > 1 ? toom3 : (level == 1 ? n : INT_MAX),
+                                          level == 2 ? n : INT_MAX);
+        double fast = timeMultiply(a, b);
+
+        cout << "  " << n << " limbs: " << slow << " ms vs " << fast << " ms" << endl;
+        wins = fast < slow ? wins + 1 : 0;
+        if (wins == 2)
+            return n - step;
+    }
+    return to;
+}
+
+
+// Same search as calibrate() for the point where square() should switch from the
+// schoolbook square to Karatsuba squaring
+int calibrateSquare(int from, int to, int step) {
+    cout << "\nschoolbook square vs Karatsuba square" << endl;
+    int wins = 0;
+    for (int n = from; n <= to; n += step) {
+        BigInteger a = randomLimbs(n);
+
+        BigInteger::setSquareThreshold(INT_MAX);
+        double slow = timeSquare(a, true);
+        BigInteger::setSquareThreshold(n);
+        double fast = timeSquare(a, true);
+
+        cout << "  " << n << " limbs: " << slow << " ms vs " << fast << " ms" << endl;
+        wins = fast < slow ? wins + 1 : 0;
+        if (wins == 2)
+            return n - step;
+    }
+    return to;
+}
+
+
+// average time of one full modular exponentiation on ctx in ms, repeated for at least
+// 50 ms
+double timePower(const MontgomeryContext& ctx, const BigInteger& base, const BigInteger& exponent) {
+    BigInteger aR = ctx.toMont(base);
+    int reps = 0;
+    const clock_t begin_time = clock();
+    do {
+        BigInteger x = ctx.power(aR, exponent);
+        reps++;
+    } while (clock() - begin_time < CLOCKS_PER_SEC / 20);
+    return float( clock () - begin_time ) * MILLIS / CLOCKS_PER_SEC / reps;
+}
+
+
+// The same search as calibrate() for the modulus size from which MontgomeryContext
+// should run its ladder on the active vector kernel instead of the scalar one; 0 when
+// the CPU has no vector kernel
+int calibrateVector(int from, int to, int step) {
+    VectorMontgomery::Kernel best = VectorMontgomery::activeKernel();
+    if (best == VectorMontgomery::SCALAR)
+        return 0;
+    cout << "\nscalar vs " << VectorMontgomery::name(best) << " Montgomery ladder" << endl;
+    VectorMontgomery::setThreshold(1);
+    int wins = 0, found = to;
+    for (int n = from; n <= to; n += step) {
+        BigInteger mod = randomLimbs(n) % (BigInteger(1) << (64 * n));
+        if (mod.isEven())
+            mod++;
+        mod.setBit(64 * n - 1);
+        BigInteger base = randomLimbs(n) % mod, exponent = randomLimbs(n) % mod;
+
+        VectorMontgomery::setKernel(VectorMontgomery::SCALAR);
+        double slow = timePower(MontgomeryContext(mod), base, exponent);
+        VectorMontgomery::setKernel(best);
+        double fast = timePower(MontgomeryContext(mod), base, exponent);
+
+        cout << "  " << n << " limbs: " << slow << " ms vs " << fast << " ms" << endl;
+        wins = fast < slow ? wins + 1 : 0;
+        if (wins == 2) {
+            found = n - step;
+            break;
+        }
+    }
+    VectorMontgomery::setThreshold(0);
+    return found;
+}
+
+
+// Differential check of the NTT path against plain schoolbook multiplication,
+// including all-ones operands that push every convolution coefficient to its bound.
+bool verifyNTT() {
+    int sizes[] = {1, 2, 3, 17, 64, 255, 256, 257, 1000, 4099};
+    bool ok = true;
+    for (int i = 0; i < 10; i++) {
+        for (int allOnes = 0; allOnes < 2; allOnes++) {
+            BigInteger a = randomLimbs(sizes[i]), b = randomLimbs(sizes[(i + 3) % 10]);
+            if (allOnes) {
+                // 2^(64n) - 1
+                a = 1;
+                for (int j = 0; j < sizes[i]; j++)
+                    a = a * BigInteger("18446744073709551616");
+                a = a - 1;
+                b = a;
+            }
+
+            BigInteger::setMultiplyThresholds(INT_MAX, INT_MAX, INT_MAX);
+            BigInteger expected = a * b;
+            BigInteger::setMultiplyThresholds(1, INT_MAX, 1);
+            BigInteger actual = a * b;
+
+            if (expected != actual) {
+                cout << "  NTT mismatch at " << sizes[i] << " limbs" << endl;
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+
+// 2^(64n) - 1, which pushes every partial product and carry to its bound
+BigInteger allOnes(int limbs) {
+    return (BigInteger(1) << (64 * limbs)) - 1;
+}
+
+
+// Differential check of Karatsuba, Toom-3 and the dedicated square against schoolbook,
+// and of Knuth's division against q * v + r == u with 0 <= r < v, at the given
+// thresholds and again with each algorithm forced down to a single limb, so thresholds
+// that keep a kernel out of the way cannot hide it being broken.
+bool verifyArithmetic(int karatsuba, int toom3, int ntt, int square) {
+    int sizes[] = {1, 2, 3, 4, 5, 7, 16, 31, 64, 100, 257, 600};
+    int settings[][4] = {{karatsuba, toom3, ntt, square}, {1, INT_MAX, INT_MAX, 1}, {1, 1, INT_MAX, 1}};
+    const char* names[] = {"calibrated thresholds", "Karatsuba from 1 limb", "Toom-3 from 1 limb"};
+    bool ok = true;
+    for (int i = 0; i < 12; i++) {
+        for (int extreme = 0; extreme < 2; extreme++) {
+            int other = sizes[(i + 3) % 12];
+            BigInteger a = extreme ? allOnes(sizes[i]) : randomLimbs(sizes[i]);
+            BigInteger b = extreme ? allOnes(other) : randomLimbs(other), c = a;
+
+            BigInteger::setMultiplyThresholds(INT_MAX, INT_MAX, INT_MAX);
+            BigInteger::setSquareThreshold(INT_MAX);
+            BigInteger product = a * b, same = a * c;
+
+            // a divisor with one top bit exercises the largest normalization shift
+            BigInteger u = product + (extreme ? b - 1 : randomLimbs(other) % b);
+            BigInteger divisors[] = {b, (BigInteger(1) << (64 * other - 64)) + 1, a};
+            for (int s = 0; s < 3; s++) {
+                const int* t = settings[s];
+                BigInteger::setMultiplyThresholds(t[0], t[1], t[2]);
+                BigInteger::setSquareThreshold(t[3]);
+                if (a * b != product || b * a != product) {
+                    cout << "  product mismatch at " << sizes[i] << " x " << other << " limbs, " << names[s] << endl;
+                    ok = false;
+                }
+                if (a * a != same) {
+                    cout << "  square mismatch at " << sizes[i] << " limbs, " << names[s] << endl;
+                    ok = false;
+                }
+                for (int d = 0; d < 3; d++) {
+                    const BigInteger& v = divisors[d];
+                    BigInteger minusU = BigInteger(0) - u;
+                    BigInteger q = u / v, r = u % v, negQ = minusU / v, negR = minusU % v;
+                    if (q * v + r != u || r < 0 || r >= v || negQ * v + negR != minusU || negR != BigInteger(0) - r) {
+                        cout << "  division mismatch at " << u.getLimbs().size() << " / " << v.getLimbs().size()
+                             << " limbs, " << names[s] << endl;
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    BigInteger::setMultiplyThresholds(karatsuba, toom3, ntt);
+    BigInteger::setSquareThreshold(square);
+    return ok;
+}
+
+
+// Differential check of every vector kernel the CPU has against the scalar ladder, with
+// the threshold out of the way: single exponentiations through MontgomeryContext and
+// full lockstep groups through powerBatch, including all-ones moduli and N - 1 as the
+// base, which keep every digit of the lanes at its largest.
+bool verifyVector() {
+    int sizes[] = {1, 2, 3, 5, 8, 9, 16, 17, 32, 64, 128};
+    VectorMontgomery::Kernel best = VectorMontgomery::detect();
+    bool ok = true;
+    for (int i = 0; i < 11; i++) {
+        for (int extreme = 0; extreme < 2; extreme++) {
+            int n = sizes[i];
+            BigInteger mod = randomLimbs(n) % (BigInteger(1) << (64 * n));
+            if (extreme)
+                mod = (BigInteger(1) << (64 * n)) - 1;
+            if (mod.isEven())
+                mod++;
+            mod.setBit(64 * n - 1);
+            BigInteger exponent = randomLimbs(min(n, 8)) % mod;
+            vector<BigInteger> bases, exponents(8, exponent);
+            for (int l = 0; l < 8; l++)
+                bases.push_back(extreme ? mod - 1 : randomLimbs(n) % mod);
+            exponents[1] = 0;
+            exponents[2] = 1;
+
+            VectorMontgomery::setKernel(VectorMontgomery::SCALAR);
+            MontgomeryContext scalar(mod);
+            vector<BigInteger> expected;
+            for (int l = 0; l < 8; l++)
+                expected.push_back(scalar.fromMont(scalar.power(scalar.toMont(bases[l]), exponents[l])));
+
+            VectorMontgomery::setThreshold(1);
+            for (int k = VectorMontgomery::AVX2; k <= best; k++) {
+                VectorMontgomery::setKernel((VectorMontgomery::Kernel) k);
+                MontgomeryContext ctx(mod);
+                bool same = powerBatch(bases, exponents, mod) == expected;
+                for (int l = 0; l < 8; l++)
+                    same = same && ctx.fromMont(ctx.power(ctx.toMont(bases[l]), exponents[l])) == expected[l];
+                if (!same) {
+                    cout << "  " << VectorMontgomery::name((VectorMontgomery::Kernel) k) << " mismatch at "
+                         << n << " limbs" << endl;
+                    ok = false;
+                }
+            }
+            VectorMontgomery::setThreshold(0);
+        }
+    }
+    VectorMontgomery::setKernel(best);
+    return ok;
+}
+
+
+// square-and-multiply on a Montgomery context, enough to drive the RSA round trip below
+BigInteger powMod(const BigInteger& base, const BigInteger& exponent, const MontgomeryContext& ctx) {
+    LimbPool::Scope scope;
+    BigInteger x = ctx.getOne(), b = ctx.toMont(base);
+    for (size_t i = exponent.bitLength(); i-- > 0; ) {
+        x = ctx.montSqr(x);
+        if (exponent.testBit(i))
+            x = ctx.montMul(x, b);
+    }
+    return ctx.fromMont(x);
+}
+
+
+// The fixed-key RSA run of rsa_biginteger (key setup, one encryption, a CRT decryption)
+// plus the small-number traffic of a few Miller-Rabin rounds, counting how many limb
+// buffers came from LimbVector's inline storage and how many from the heap.
+void countAllocations() {
+    unsigned long long inlineBefore = LimbVector::inlineAllocations();
+    unsigned long long heapBefore = LimbVector::heapAllocations();
+    unsigned long long pooledBefore = LimbPool::allocationsServed();
+    unsigned long long bytesBefore = LimbPool::bytesServed();
+    unsigned long long systemBefore = LimbPool::systemAllocations();
+
+    BigInteger p("8290515735040856273279920028019754089906648110503848228748187375207350805510166301444321260999006754288859997100400526846118668190294438035469087208971");
+    BigInteger q("1201220374814320143127279864545495373815987095424121160482538063721483660688779311129370377018803872219275627461811376074607800016797301371429593867351");
+    BigInteger N = p * q;
+    BigInteger phiN = (p - 1) * (q - 1);
+
+    BigInteger e = 3;
+    while (BigInteger::compare(gcdMagnitude(e.getLimbs(), phiN.getLimbs()), LimbVector(1, 1)) != 0)
+        e += 2;
+    LimbVector x, y;
+    bool xNeg, yNeg;
+    gcdExtendedMagnitude(e.getLimbs(), phiN.getLimbs(), x, xNeg, y, yNeg);
+    BigInteger d;
+    d.setLimbs(x);
+    if (xNeg)
+        d = phiN - d;
+
+    MontgomeryContext ctxN(N), ctxP(p), ctxQ(q);
+    BigInteger c = powMod(42, e, ctxN);
+    BigInteger m1 = powMod(c, d % (p - 1), ctxP);
+    BigInteger m2 = powMod(c, d % (q - 1), ctxQ);
+
+    for (int i = 0; i < 5; i++) {
+        BigInteger s = p - 1, a = (BigInteger) rand() % (p - 1) + 1;
+        s >>= s.countTrailingZeros();
+        powMod(a, s, ctxP);
+    }
+
+    unsigned long long inlineCount = LimbVector::inlineAllocations() - inlineBefore;
+    unsigned long long heapCount = LimbVector::heapAllocations() - heapBefore;
+    cout << "  limb buffers: " << inlineCount + heapCount << ", served inline: " << inlineCount
+         << ", from the heap: " << heapCount << endl;
+    cout << "  heap allocations avoided: " << 100.0 * inlineCount / (inlineCount + heapCount) << "%" << endl;
+
+    unsigned long long pooled = LimbPool::allocationsServed() - pooledBefore;
+    unsigned long long system = LimbPool::systemAllocations() - systemBefore;
+    cout << "  heap buffers requested inside pool scopes: " << pooled << " ("
+         << (LimbPool::bytesServed() - bytesBefore) / 1024 << " KiB), reused from the pool: "
+         << pooled - system << ", taken from malloc: " << system << endl;
+    if (m1 != 42 || m2 != 42)
+        cout << "  decryption mismatch" << endl;
+}
+
+
+// Miller-Rabin at the default 2^-100 error bound: one full test of a known prime, and
+// the next prime from a random start found by testing every odd number and through
+// the sieve, which only hands over candidates without small factors
+void timePrimeSearch(int limbs) {
+    BigInteger start = randomLimbs(limbs);
+    if (start.isEven())
+        start++;
+
+    clock_t begin = clock();
+    BigInteger p = start;
+    int candidates = 1;
+    while (!isProbablePrime(p)) {
+        p += 2;
+        candidates++;
+    }
+    double walk = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC;
+
+    begin = clock();
+    BigInteger sieved = nextProbablePrime(start);
+    double sieve = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC;
+
+    begin = clock();
+    isProbablePrime(p);
+    double test = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC;
+    cout << "  " << p.bitLength() << " bits: " << test << " ms to confirm a prime; next prime after "
+         << candidates << " odd candidates in " << walk << " ms, sieved in " << sieve << " ms" << endl;
+    if (sieved != p)
+        cout << "  sieve mismatch" << endl;
+}
+
+
+// cost per candidate of the primorial gcd against one Miller-Rabin round, and the share
+// of random odd candidates the filter rejects
+void timePrimorialFilter(int limbs, int count) {
+    vector<BigInteger> candidates(count);
+    for (int i = 0; i < count; i++) {
+        candidates[i] = randomLimbs(limbs);
+        if (candidates[i].isEven())
+            candidates[i]++;
+    }
+    // builds and caches the product outside the timing
+    hasSmallFactor(candidates[0]);
+
+    clock_t begin = clock();
+    int rejected = 0;
+    for (int i = 0; i < count; i++)
+        rejected += hasSmallFactor(candidates[i]);
+    double single = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC / count;
+
+    begin = clock();
+    for (int i = 0; i < count; i++)
+        MillerRabin(candidates[i]).isWitness(2);
+    double round = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC / count;
+
+    cout << "  " << candidates[0].bitLength() << " bits: " << 100.0 * rejected / count
+         << "% rejected at " << single << " ms each; one Miller-Rabin round " << round << " ms" << endl;
+}
+
+
+// bulk output of this thread's ChaCha20 generator in MiB/s, filling 4096-bit buffers
+double randomThroughput() {
+    LimbVector limbs(64);
+    RandomSource& random = RandomSource::forThread();
+    clock_t begin = clock();
+    int rounds = 200000;
+    for (int i = 0; i < rounds; i++)
+        random.fill(limbs.data(), limbs.size());
+    double seconds = float(clock() - begin) / CLOCKS_PER_SEC;
+    return rounds * limbs.size() * sizeof(limb_t) / seconds / (1 << 20);
+}
+
+
+// one modular exponentiation with a full-length exponent per key size, on BigInteger
+// and on FixedBigInt<Bits>, with the heap allocations each one made
+template <size_t Bits>
+void timeFixedPower(int runs) {
+    BigInteger mod = randomLimbs(Bits / 64) % (BigInteger(1) << Bits);
+    if (mod.isEven())
+        mod++;
+    mod.setBit(Bits - 1);
+    BigInteger base = randomLimbs(Bits / 64) % mod, exponent = randomLimbs(Bits / 64) % mod;
+
+    MontgomeryContext ctx(mod);
+    unsigned long long heapBefore = LimbVector::heapAllocations();
+    clock_t begin = clock();
+    BigInteger expected;
+    for (int i = 0; i < runs; i++)
+        expected = ctx.fromMont(ctx.power(ctx.toMont(base), exponent));
+    double general = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC / runs;
+    unsigned long long generalHeap = (LimbVector::heapAllocations() - heapBefore) / runs;
+
+    FixedMontgomeryContext<Bits> fixedCtx((FixedBigInt<Bits>(mod)));
+    FixedBigInt<Bits> fixedBase(base), fixedExponent(exponent), result;
+    heapBefore = LimbVector::heapAllocations();
+    begin = clock();
+    for (int i = 0; i < runs; i++)
+        result = fixedCtx.fromMont(fixedCtx.power(fixedCtx.toMont(fixedBase), fixedExponent));
+    double fixed = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC / runs;
+    unsigned long long fixedHeap = (LimbVector::heapAllocations() - heapBefore) / runs;
+
+    cout << "  " << Bits << " bits: BigInteger " << general << " ms (" << generalHeap << " heap buffers), FixedBigInt "
+         << fixed << " ms (" << fixedHeap << "), " << general / fixed << "x" << endl;
+    if (result.toBigInteger() != expected)
+        cout << "  FixedBigInt mismatch" << endl;
+}
+
+
+// one full-length modular exponentiation on each vector kernel the CPU has, against
+// the scalar ladder, with the vector threshold out of the way
+void timeVectorPower(int limbs, int runs) {
+    BigInteger mod = randomLimbs(limbs) % (BigInteger(1) << (64 * limbs));
+    if (mod.isEven())
+        mod++;
+    mod.setBit(64 * limbs - 1);
+    BigInteger base = randomLimbs(limbs) % mod, exponent = randomLimbs(limbs) % mod;
+
+    VectorMontgomery::Kernel best = VectorMontgomery::activeKernel();
+    VectorMontgomery::setThreshold(1);
+    cout << "  " << 64 * limbs << " bits:";
+    double scalar = 0;
+    BigInteger expected;
+    for (int k = VectorMontgomery::SCALAR; k <= best; k++) {
+        VectorMontgomery::setKernel((VectorMontgomery::Kernel) k);
+        MontgomeryContext ctx(mod);
+        BigInteger result;
+        clock_t begin = clock();
+        for (int i = 0; i < runs; i++)
+            result = ctx.fromMont(ctx.power(ctx.toMont(base), exponent));
+        double time = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC / runs;
+        if (k == VectorMontgomery::SCALAR) {
+            scalar = time;
+            expected = result;
+        }
+        cout << " " << VectorMontgomery::name((VectorMontgomery::Kernel) k) << " " << time << " ms";
+        if (k != VectorMontgomery::SCALAR)
+            cout << " (" << scalar / time << "x)";
+        if (result != expected)
+            cout << " MISMATCH";
+    }
+    cout << endl;
+    VectorMontgomery::setKernel(best);
+    VectorMontgomery::setThreshold(0);
+}
+
+
+// milliseconds per exponentiation for one lockstep group of full-length tuples, through
+// powerBatch and one by one through MontgomeryContext, with distinct moduli and with a
+// single shared one
+void timeBatchPower(int bits, int runs) {
+    size_t lanes = batchLanes();
+    RandomSource& random = RandomSource::forThread();
+    vector<BigInteger> bases, exponents, moduli;
+    for (size_t i = 0; i < lanes; i++) {
+        BigInteger mod = random.randomWithBits(bits);
+        if (mod.isEven())
+            mod++;
+        moduli.push_back(mod);
+        bases.push_back(random.randomBelow(mod));
+        exponents.push_back(random.randomWithBits(bits));
+    }
+
+    cout << "  " << bits << " bits, " << lanes << " lanes:";
+    for (int shared = 0; shared < 2; shared++) {
+        if (shared)
+            moduli.assign(lanes, moduli[0]);
+        vector<BigInteger> expected(lanes), results;
+        clock_t begin = clock();
+        for (int r = 0; r < runs; r++) {
+            for (size_t i = 0; i < lanes; i++) {
+                MontgomeryContext ctx(moduli[i]);
+                expected[i] = ctx.fromMont(ctx.power(ctx.toMont(bases[i]), exponents[i]));
+            }
+        }
+        double single = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC / runs / lanes;
+        begin = clock();
+        for (int r = 0; r < runs; r++)
+            results = powerBatch(bases, exponents, moduli);
+        double batch = float(clock() - begin) * MILLIS / CLOCKS_PER_SEC / runs / lanes;
+
+        cout << (shared ? ", shared modulus " : " distinct moduli ") << single << " ms one by one, "
+             << batch << " ms batched (" << single / batch << "x)";
+        if (results != expected)
+            cout << " MISMATCH";
+    }
+    cout << endl;
+}
+
+
+// wall-clock milliseconds per prime over a few searches; clock() would add up the
+// CPU time of every worker
+double timePrimeGeneration(int bits, int threads, int runs) {
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        BigInteger p = generatePrime(bits, threads);
+        if ((int) p.bitLength() != bits || !isProbablePrime(p))
+            cout << "  bad prime from generatePrime" << endl;
+    }
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count() / runs;
+}
+
+
+int main() {
+    srand(1);
+    cout << "NTT differential check against schoolbook" << endl;
+    if (!verifyNTT())
+        return 1;
+    cout << "  ok" << endl;
+
+    cout << "\nVector kernel differential check against the scalar ladder" << endl;
+    if (!verifyVector())
+        return 1;
+    cout << "  ok" << endl;
+
+    cout << "\nLimb buffer allocations in one RSA round trip" << endl;
+    countAllocations();
+
+    cout << "\nMultiplication threshold calibration" << endl;
+    int karatsuba = calibrate("schoolbook vs Karatsuba", 0, 8, 128, 4, 0, 0);
+    int toom3 = calibrate("Karatsuba vs Toom-3", 1, karatsuba + 8, 512, 8, karatsuba, 0);
+    int ntt = calibrate("Toom-3 vs NTT", 2, toom3 + 64, 8192, 128, karatsuba, toom3);
+
+    BigInteger::setMultiplyThresholds(karatsuba, toom3, ntt);
+    int square = calibrateSquare(karatsuba, 256, 4);
+    BigInteger::setSquareThreshold(square);
+
+    cout << "\nMultiplication and division differential check against schoolbook" << endl;
+    if (!verifyArithmetic(karatsuba, toom3, ntt, square))
+        return 1;
+    cout << "  ok" << endl;
+
+    size_t vectorDefault = VectorMontgomery::threshold();
+    int vector = calibrateVector(2, 64, 2);
+    VectorMontgomery::setThreshold(vector);
+
+    cout << "\nSquaring against the general product x * x" << endl;
+    int sizes[] = {4, 8, 16, 32, 64, 128, 256, 512};
+    for (int i = 0; i < 8; i++) {
+        BigInteger a = randomLimbs(sizes[i]);
+        double general = timeSquare(a, false), dedicated = timeSquare(a, true);
+        cout << "  " << sizes[i] << " limbs: " << general << " ms vs " << dedicated << " ms, "
+             << general / dedicated << "x" << endl;
+    }
+
+    cout << "\nPrime search" << endl;
+    timePrimeSearch(8);
+    timePrimeSearch(16);
+
+    cout << "\nModular exponentiation by key size" << endl;
+    timeFixedPower<1024>(20);
+    timeFixedPower<2048>(5);
+    timeFixedPower<4096>(2);
+
+    cout << "\nModular exponentiation by vector kernel" << endl;
+    int vectorSizes[] = {2, 4, 6, 8, 12, 16, 32, 48, 64};
+    for (int i = 0; i < 9; i++)
+        timeVectorPower(vectorSizes[i], max(1, 4096 / (vectorSizes[i] * vectorSizes[i] * vectorSizes[i] / 8 + 1)));
+
+    cout << "\nBatch modular exponentiation, per exponentiation" << endl;
+    timeBatchPower(512, 40);
+    timeBatchPower(1024, 10);
+    timeBatchPower(2048, 2);
+    timeBatchPower(4096, 1);
+
+    cout << "\nChaCha20 random limbs: " << randomThroughput() << " MiB/s" << endl;
+
+    cout << "\nPrimorial filter" << endl;
+    timePrimorialFilter(8, 256);
+    timePrimorialFilter(16, 256);
+
+    cout << "\nParallel prime generation, wall clock per prime" << endl;
+    int bitSizes[] = {512, 1024};
+    for (int i = 0; i < 2; i++) {
+        double single = timePrimeGeneration(bitSizes[i], 1, 8);
+        double parallel = timePrimeGeneration(bitSizes[i], 0, 8);
+        cout << "  " << bitSizes[i] << " bits: " << single << " ms on one thread, " << parallel
+             << " ms on " << thread::hardware_concurrency() << ", " << single / parallel << "x" << endl;
+    }
+
+    cout << "\nkaratsubaThreshold = " << karatsuba << endl;
+    cout << "toom3Threshold = " << toom3 << endl;
+    cout << "nttThreshold = " << ntt << endl;
+    cout << "squareThreshold = " << square << endl;
+    if (vector != 0)
+        cout << "vectorThreshold = " << vector << " (" << VectorMontgomery::name(VectorMontgomery::activeKernel())
+             << ", default " << vectorDefault << ")" << endl;
+    return 0;
+}